@@ -8007,6 +8007,82 @@ static void test_add_font_path(void)
     SetCurrentDirectoryW( cwd );
 }
 
+static INT CALLBACK write_font_list_proc(const LOGFONTA *lf, const TEXTMETRICA *tm, DWORD type, LPARAM lparam)
+{
+    const ENUMLOGFONTEXA *elf = (const ENUMLOGFONTEXA *)lf;
+
+    fprintf((FILE *)lparam, "%s|%s|%s|%u|%lu|%ld\n", lf->lfFaceName, elf->elfFullName, elf->elfStyle,
+            lf->lfCharSet, type, tm->tmWeight);
+    return 1;
+}
+
+static void write_font_list(const char *filename)
+{
+    LOGFONTA lf;
+    FILE *file;
+    HDC hdc;
+
+    file = fopen(filename, "w");
+    ok(file != NULL, "failed to open %s\n", filename);
+    if (!file) return;
+
+    hdc = GetDC(0);
+    memset(&lf, 0, sizeof(lf));
+    lf.lfCharSet = DEFAULT_CHARSET;
+    EnumFontFamiliesExA(hdc, &lf, write_font_list_proc, (LPARAM)file, 0);
+    ReleaseDC(0, hdc);
+    fclose(file);
+}
+
+static void test_font_list_other_process(const char *argv0)
+{
+    char temp_path[MAX_PATH], list1[MAX_PATH], list2[MAX_PATH], cmdline[3 * MAX_PATH];
+    char line1[1024], line2[1024], *ret1, *ret2;
+    PROCESS_INFORMATION info;
+    STARTUPINFOA startup;
+    FILE *file1, *file2;
+    int count = 0;
+
+    GetTempPathA(MAX_PATH, temp_path);
+    GetTempFileNameA(temp_path, "fnt", 0, list1);
+    GetTempFileNameA(temp_path, "fnt", 0, list2);
+
+    write_font_list(list1);
+
+    /* a new process gets its font list from the font caches, it has to match */
+    memset(&startup, 0, sizeof(startup));
+    startup.cb = sizeof(startup);
+    sprintf(cmdline, "%s font font_list %s", argv0, list2);
+    ok(CreateProcessA(NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &startup, &info),
+        "CreateProcess failed.\n");
+    wait_child_process(&info);
+    CloseHandle(info.hProcess);
+    CloseHandle(info.hThread);
+
+    file1 = fopen(list1, "r");
+    ok(file1 != NULL, "failed to open %s\n", list1);
+    file2 = fopen(list2, "r");
+    ok(file2 != NULL, "failed to open %s\n", list2);
+    if (file1 && file2)
+    {
+        for (;;)
+        {
+            ret1 = fgets(line1, sizeof(line1), file1);
+            ret2 = fgets(line2, sizeof(line2), file2);
+            if (!ret1 || !ret2) break;
+            ok(!strcmp(line1, line2), "%d: got %s, expected %s\n", count, debugstr_a(line2), debugstr_a(line1));
+            if (strcmp(line1, line2)) break;
+            count++;
+        }
+        ok(!ret1 && !ret2, "the font lists differ after %d fonts\n", count);
+        ok(count > 0, "no fonts were enumerated\n");
+    }
+    if (file1) fclose(file1);
+    if (file2) fclose(file2);
+    DeleteFileA(list1);
+    DeleteFileA(list2);
+}
+
 START_TEST(font)
 {
     static const char *test_names[] =
@@ -8025,9 +8101,14 @@ START_TEST(font)
     {
         if (!strcmp(argv[2], "AddFontMemResource"))
             test_AddFontMemResource();
+        else if (!strcmp(argv[2], "font_list") && argc >= 4)
+            write_font_list(argv[3]);
         return;
     }
 
+    /* run before the tests that add fonts to the process */
+    test_font_list_other_process(argv[0]);
+
     test_stock_fonts();
     test_logfont();
     test_bitmap_font();
@@ -5496,6 +5496,79 @@ static void test_file_access(void)
     }
 }
 
+static void test_duplicate_file_handle(void)
+{
+    char path[MAX_PATH], fname[MAX_PATH], buf[32];
+    HANDLE hfile, hdup, hdup2;
+    DWORD ret, bytes;
+
+    GetTempPathA(MAX_PATH, path);
+    GetTempFileNameA(path, "dup", 0, fname);
+
+    hfile = CreateFileA(fname, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, 0);
+    ok(hfile != INVALID_HANDLE_VALUE, "CreateFile error %ld\n", GetLastError());
+
+    /* use the source handle first so that its unix fd is cached */
+    ret = WriteFile(hfile, "abcd", 4, &bytes, NULL);
+    ok(ret, "WriteFile error %ld\n", GetLastError());
+    ok(bytes == 4, "expected 4, got %lu\n", bytes);
+
+    ret = DuplicateHandle(GetCurrentProcess(), hfile, GetCurrentProcess(), &hdup,
+                          0, FALSE, DUPLICATE_SAME_ACCESS);
+    ok(ret, "DuplicateHandle error %ld\n", GetLastError());
+    ok(hdup != hfile, "got the same handle %p\n", hdup);
+
+    ret = WriteFile(hdup, "efgh", 4, &bytes, NULL);
+    ok(ret, "WriteFile error %ld\n", GetLastError());
+    ok(bytes == 4, "expected 4, got %lu\n", bytes);
+    ret = SetFilePointer(hfile, 0, NULL, FILE_CURRENT);
+    ok(ret == 8, "expected 8, got %lu\n", ret);
+
+    ret = SetFilePointer(hdup, 0, NULL, FILE_BEGIN);
+    ok(ret != INVALID_SET_FILE_POINTER, "SetFilePointer error %ld\n", GetLastError());
+    memset(buf, 0, sizeof(buf));
+    ret = ReadFile(hdup, buf, sizeof(buf), &bytes, NULL);
+    ok(ret, "ReadFile error %ld\n", GetLastError());
+    ok(bytes == 8, "expected 8, got %lu\n", bytes);
+    ok(!memcmp(buf, "abcdefgh", 8), "got %s\n", debugstr_an(buf, bytes));
+
+    /* the duplicate must keep working once the source is closed */
+    ret = CloseHandle(hfile);
+    ok(ret, "CloseHandle error %ld\n", GetLastError());
+    ret = WriteFile(hdup, "ijkl", 4, &bytes, NULL);
+    ok(ret, "WriteFile error %ld\n", GetLastError());
+    ok(bytes == 4, "expected 4, got %lu\n", bytes);
+
+    ret = DuplicateHandle(GetCurrentProcess(), hdup, GetCurrentProcess(), &hdup2,
+                          0, FALSE, DUPLICATE_SAME_ACCESS | DUPLICATE_CLOSE_SOURCE);
+    ok(ret, "DuplicateHandle error %ld\n", GetLastError());
+
+    ret = WriteFile(hdup2, "mnop", 4, &bytes, NULL);
+    ok(ret, "WriteFile error %ld\n", GetLastError());
+    ok(bytes == 4, "expected 4, got %lu\n", bytes);
+
+    ret = SetFilePointer(hdup2, 0, NULL, FILE_BEGIN);
+    ok(ret != INVALID_SET_FILE_POINTER, "SetFilePointer error %ld\n", GetLastError());
+    memset(buf, 0, sizeof(buf));
+    ret = ReadFile(hdup2, buf, sizeof(buf), &bytes, NULL);
+    ok(ret, "ReadFile error %ld\n", GetLastError());
+    ok(bytes == 16, "expected 16, got %lu\n", bytes);
+    ok(!memcmp(buf, "abcdefghijklmnop", 16), "got %s\n", debugstr_an(buf, bytes));
+
+    if (hdup2 != hdup)
+    {
+        SetLastError(0xdeadbeef);
+        ret = CloseHandle(hdup);
+        ok(!ret, "CloseHandle should fail\n");
+        ok(GetLastError() == ERROR_INVALID_HANDLE, "expected ERROR_INVALID_HANDLE, got %ld\n", GetLastError());
+    }
+    ret = CloseHandle(hdup2);
+    ok(ret, "CloseHandle error %ld\n", GetLastError());
+
+    ret = DeleteFileA(fname);
+    ok(ret, "DeleteFile error %ld\n", GetLastError());
+}
+
 static void test_GetFinalPathNameByHandleA(void)
 {
     static char prefix[] = "GetFinalPathNameByHandleA";
@@ -6965,6 +7038,7 @@ START_TEST(file)
     test_SetFileValidData();
     test_WriteFileGather();
     test_file_access();
+    test_duplicate_file_handle();
     test_GetFinalPathNameByHandleA();
     test_GetFinalPathNameByHandleW();
     test_SetFileInformationByHandle();
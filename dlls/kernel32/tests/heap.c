@@ -1262,6 +1262,105 @@ static void test_HeapCreate(void)
 }
 
 
+struct lfh_thread_params
+{
+    HANDLE heap;
+    void **ptrs;
+    UINT count;
+};
+
+static DWORD WINAPI lfh_thread_proc( void *arg )
+{
+    struct lfh_thread_params *params = arg;
+    UINT i, j;
+    BOOL ret;
+
+    for (i = 0; i < 64; i++)
+    {
+        /* free the blocks allocated by the previous thread before replacing them */
+        for (j = 0; j < params->count; j++)
+        {
+            void *ptr = InterlockedExchangePointer( &params->ptrs[j], NULL );
+            if (ptr)
+            {
+                ret = HeapFree( params->heap, 0, ptr );
+                ok( ret, "HeapFree failed, error %lu\n", GetLastError() );
+            }
+            ptr = HeapAlloc( params->heap, 0, 8 + (j % 8) * 16 );
+            ok( !!ptr, "HeapAlloc failed, error %lu\n", GetLastError() );
+            if ((ptr = InterlockedExchangePointer( &params->ptrs[j], ptr )))
+                HeapFree( params->heap, 0, ptr );
+        }
+    }
+
+    return 0;
+}
+
+static void test_lfh_threads(void)
+{
+    struct lfh_thread_params params;
+    PROCESS_HEAP_ENTRY entry;
+    HANDLE threads[8];
+    ULONG compat_info;
+    void *ptrs[256];
+    UINT i, count;
+    BOOL ret;
+    DWORD res;
+
+    params.heap = HeapCreate( 0, 0, 0 );
+    ok( !!params.heap, "HeapCreate failed, error %lu\n", GetLastError() );
+    compat_info = 2;
+    ret = pHeapSetInformation( params.heap, HeapCompatibilityInformation, &compat_info, sizeof(compat_info) );
+    ok( ret, "HeapSetInformation failed, error %lu\n", GetLastError() );
+
+    memset( ptrs, 0, sizeof(ptrs) );
+    params.ptrs = ptrs;
+    params.count = ARRAY_SIZE(ptrs);
+
+    /* threads concurrently allocate and free each other's blocks */
+    for (i = 0; i < ARRAY_SIZE(threads); i++)
+    {
+        threads[i] = CreateThread( NULL, 0, lfh_thread_proc, &params, 0, NULL );
+        ok( !!threads[i], "CreateThread failed, error %lu\n", GetLastError() );
+    }
+    res = WaitForMultipleObjects( ARRAY_SIZE(threads), threads, TRUE, INFINITE );
+    ok( !res, "WaitForMultipleObjects returned %#lx, error %lu\n", res, GetLastError() );
+    for (i = 0; i < ARRAY_SIZE(threads); i++) CloseHandle( threads[i] );
+
+    ret = HeapValidate( params.heap, 0, NULL );
+    ok( ret, "HeapValidate failed\n" );
+
+    for (i = 0; i < ARRAY_SIZE(ptrs); i++)
+    {
+        ok( !!ptrs[i], "got NULL pointer %u\n", i );
+        ret = HeapValidate( params.heap, 0, ptrs[i] );
+        ok( ret, "HeapValidate failed for %p\n", ptrs[i] );
+    }
+
+    count = 0;
+    memset( &entry, 0, sizeof(entry) );
+    while ((ret = HeapWalk( params.heap, &entry )))
+    {
+        for (i = 0; i < ARRAY_SIZE(ptrs); i++) if (entry.lpData == ptrs[i]) break;
+        if (i < ARRAY_SIZE(ptrs))
+        {
+            ok( entry.wFlags & PROCESS_HEAP_ENTRY_BUSY, "got flags %#x for %p\n", entry.wFlags, entry.lpData );
+            count++;
+        }
+    }
+    ok( count == ARRAY_SIZE(ptrs), "found %u allocated blocks\n", count );
+
+    for (i = 0; i < ARRAY_SIZE(ptrs); i++)
+    {
+        ret = HeapFree( params.heap, 0, ptrs[i] );
+        ok( ret, "HeapFree failed, error %lu\n", GetLastError() );
+    }
+
+    ret = HeapDestroy( params.heap );
+    ok( ret, "HeapDestroy failed, error %lu\n", GetLastError() );
+}
+
+
 struct mem_entry
 {
     UINT_PTR flags;
@@ -3877,6 +3976,7 @@ START_TEST(heap)
     }
 
     test_HeapCreate();
+    test_lfh_threads();
     test_GlobalAlloc();
     test_LocalAlloc();
 
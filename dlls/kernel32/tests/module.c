@@ -355,6 +355,40 @@ static void testGetProcAddress_Wrong(void)
     ok( GetLastError() == ERROR_MOD_NOT_FOUND, "Expected ERROR_MOD_NOT_FOUND, got %ld\n", GetLastError() );
 }
 
+static void testGetProcAddress_exports(void)
+{
+    HMODULE module = GetModuleHandleA( "kernel32.dll" );
+    const IMAGE_NT_HEADERS *nt = (const IMAGE_NT_HEADERS *)((const char *)module + ((const IMAGE_DOS_HEADER *)module)->e_lfanew);
+    const IMAGE_DATA_DIRECTORY *dir = &nt->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+    const IMAGE_EXPORT_DIRECTORY *exports = (const IMAGE_EXPORT_DIRECTORY *)((const char *)module + dir->VirtualAddress);
+    const DWORD *names = (const DWORD *)((const char *)module + exports->AddressOfNames);
+    const WORD *ordinals = (const WORD *)((const char *)module + exports->AddressOfNameOrdinals);
+    const DWORD *functions = (const DWORD *)((const char *)module + exports->AddressOfFunctions);
+    DWORD i, rva, pass;
+
+    /* repeated lookups have to return the same results, whichever way the exports are searched */
+    for (pass = 0; pass < 2; pass++)
+    {
+        for (i = 0; i < exports->NumberOfNames; i++)
+        {
+            const char *name = (const char *)module + names[i];
+            FARPROC proc = GetProcAddress( module, name );
+
+            rva = functions[ordinals[i]];
+            /* forwarded exports resolve to another module */
+            if (rva >= dir->VirtualAddress && rva < dir->VirtualAddress + dir->Size) continue;
+            ok( proc == (FARPROC)((const char *)module + rva), "%lu: got %p for %s, expected %p\n",
+                pass, proc, name, (const char *)module + rva );
+        }
+
+        SetLastError( 0xdeadbeef );
+        ok( !GetProcAddress( module, "non_ex_call" ), "non_ex_call should not be found\n" );
+        ok( GetLastError() == ERROR_PROC_NOT_FOUND, "Expected ERROR_PROC_NOT_FOUND, got %ld\n", GetLastError() );
+        ok( !GetProcAddress( module, "getprocaddress" ), "getprocaddress should not be found\n" );
+        ok( GetProcAddress( module, "GetProcAddress" ) == (FARPROC)GetProcAddress, "GetProcAddress not found\n" );
+    }
+}
+
 static void testLoadLibraryEx(void)
 {
     CHAR path[MAX_PATH];
@@ -2102,6 +2136,7 @@ START_TEST(module)
     testNestedLoadLibraryA();
     testLoadLibraryA_Wrong();
     testGetProcAddress_Wrong();
+    testGetProcAddress_exports();
     testLoadLibraryEx();
     test_LoadLibraryEx_search_flags();
     testGetModuleHandleEx();
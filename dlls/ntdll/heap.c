@@ -36,6 +36,7 @@
 #include "wine/debug.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(heap);
+WINE_DECLARE_DEBUG_CHANNEL(heapstats);
 
 /* HeapCompatibilityInformation values */
 
@@ -331,6 +332,7 @@ C_ASSERT( HEAP_MIN_LARGE_BLOCK_SIZE <= HEAP_INITIAL_GROW_SIZE );
 static struct heap *process_heap;  /* main process heap */
 
 static NTSTATUS heap_free_block_lfh( struct heap *heap, ULONG flags, struct block *block );
+static void heap_dump_stats( const struct heap *heap );
 
 /* check if memory range a contains memory range b */
 static inline BOOL contains( const void *a, SIZE_T a_size, const void *b, SIZE_T b_size )
@@ -1646,6 +1648,13 @@ HANDLE WINAPI RtlDestroyHeap( HANDLE handle )
 
     if (heap == process_heap) return handle; /* cannot delete the main process heap */
 
+    if (TRACE_ON(heapstats))
+    {
+        heap_lock( heap, 0 );
+        heap_dump_stats( heap );
+        heap_unlock( heap, 0 );
+    }
+
     /* remove it from the per-process list */
     RtlEnterCriticalSection( &process_heap->cs );
     list_remove( &heap->entry );
@@ -1741,8 +1750,13 @@ struct DECLSPEC_ALIGN(BLOCK_ALIGN) group
     SLIST_ENTRY entry;
     /* one bit for each free block and the highest bit for GROUP_FLAG_FREE */
     LONG free_bits;
-    /* affinity of the thread which last allocated from this group */
-    LONG affinity;
+    union
+    {
+        /* free blocks taken from free_bits by the owning thread, only accessed while owned */
+        LONG owned_bits;
+        /* affinity of the thread which last allocated from this group, only valid when fully used */
+        LONG affinity;
+    };
     /* first block of a group, required for alignment */
     struct block first_block;
 };
@@ -1777,10 +1791,14 @@ static inline struct block *group_get_block( struct group *group, SIZE_T block_s
 /* lookup a free block using the group free_bits, the current thread must own the group */
 static inline struct block *group_find_free_block( struct group *group, SIZE_T block_size )
 {
-    ULONG i, free_bits = ReadNoFence( &group->free_bits );
-    /* free_bits will never be 0 as the group is unlinked when it's fully used */
-    BitScanForward( &i, free_bits );
-    InterlockedAnd( &group->free_bits, ~(1 << i) );
+    ULONG i;
+
+    /* take all the blocks freed since the group was last used at once, so that
+     * the following allocations don't need an atomic operation on free_bits */
+    if (!group->owned_bits) group->owned_bits = InterlockedExchange( &group->free_bits, 0 );
+    /* owned_bits will never be 0 as the group is unlinked when it's fully used */
+    BitScanForward( &i, group->owned_bits );
+    group->owned_bits &= ~(1 << i);
     return group_get_block( group, block_size, i );
 }
 
@@ -1807,6 +1825,7 @@ static struct group *group_allocate( struct heap *heap, ULONG flags, SIZE_T bloc
 
     block_set_flags( (struct block *)group - 1, 0, BLOCK_FLAG_LFH );
     group->free_bits = ~GROUP_FLAG_FREE;
+    group->owned_bits = 0;
 
     for (i = 0; i < GROUP_BLOCK_COUNT; ++i)
     {
@@ -1877,6 +1896,8 @@ static NTSTATUS heap_release_bin_group( struct heap *heap, ULONG flags, struct b
 {
     ULONG affinity = group->affinity;
 
+    group->owned_bits = 0;
+
     /* using InterlockedExchangePointer here would possibly return a group that has used blocks,
      * we prefer keeping our fully freed group instead for reduced memory consumption.
      */
@@ -1903,18 +1924,22 @@ static struct block *find_free_bin_block( struct heap *heap, ULONG flags, SIZE_T
      * some other thread might still set the free bits if they are freeing blocks.
      */
     if (!(group = heap_acquire_bin_group( heap, flags, block_size, bin ))) return NULL;
-    group->affinity = affinity;
 
     block = group_find_free_block( group, block_size );
 
-    /* serialize with heap_free_block_lfh: atomically set GROUP_FLAG_FREE when the free bits are all 0. */
-    if (ReadNoFence( &group->free_bits ) || InterlockedCompareExchange( &group->free_bits, GROUP_FLAG_FREE, 0 ))
+    if (!group->owned_bits && !ReadNoFence( &group->free_bits ))
     {
-        /* if GROUP_FLAG_FREE isn't set, thread is responsible for putting it back into group list. */
-        if ((group = InterlockedExchangePointer( (void *)bin_get_affinity_group( bin, affinity ), group )))
-            RtlInterlockedPushEntrySList( &bin->groups, &group->entry );
+        /* owned_bits is 0, its storage now holds the affinity for heap_release_bin_group */
+        group->affinity = affinity;
+        /* serialize with heap_free_block_lfh: atomically set GROUP_FLAG_FREE when the free bits are all 0. */
+        if (!InterlockedCompareExchange( &group->free_bits, GROUP_FLAG_FREE, 0 )) return block;
+        group->owned_bits = 0;
     }
 
+    /* if GROUP_FLAG_FREE isn't set, thread is responsible for putting it back into group list. */
+    if ((group = InterlockedExchangePointer( (void *)bin_get_affinity_group( bin, affinity ), group )))
+        RtlInterlockedPushEntrySList( &bin->groups, &group->entry );
+
     return block;
 }
 
@@ -2032,6 +2057,118 @@ void heap_thread_detach(void)
     RtlLeaveCriticalSection( &process_heap->cs );
 }
 
+/* count the used blocks of an LFH group */
+static void group_get_stats( const struct group *group, SIZE_T *used_count, SIZE_T *used_size )
+{
+    SIZE_T i, block_size = block_get_size( &group->first_block );
+
+    for (i = 0; i < GROUP_BLOCK_COUNT; ++i)
+    {
+        const struct block *block = group_get_block( (struct group *)group, block_size, i );
+        if (block_get_flags( block ) & BLOCK_FLAG_FREE) continue;
+        *used_size += block_size;
+        (*used_count)++;
+    }
+}
+
+/* dump a summary of the heap memory usage, the heap must be locked */
+static void heap_dump_stats( const struct heap *heap )
+{
+    SIZE_T reserved = 0, committed = 0, used = 0, free = 0, largest_free = 0, used_count = 0, free_count = 0;
+    SIZE_T groups = 0, group_size = 0, lfh_count = 0, lfh_size = 0, large_count = 0, large_size = 0;
+    UINT subheap_count = 0, enabled_count = 0, i;
+    const struct block *block;
+    const ARENA_LARGE *large;
+    const SUBHEAP *subheap;
+
+    LIST_FOR_EACH_ENTRY( subheap, &heap->subheap_list, SUBHEAP, entry )
+    {
+        const char *base = subheap_base( subheap );
+
+        subheap_count++;
+        reserved += subheap_size( subheap );
+        committed += (const char *)subheap_commit_end( subheap ) - base;
+
+        for (block = first_block( subheap ); block; block = next_block( subheap, block ))
+        {
+            SIZE_T block_size = block_get_size( block );
+
+            if (block_get_flags( block ) & BLOCK_FLAG_FREE)
+            {
+                free += block_size;
+                free_count++;
+                if (block_size > largest_free) largest_free = block_size;
+            }
+            else if (block_get_flags( block ) & BLOCK_FLAG_LFH)
+            {
+                group_get_stats( (const struct group *)(block + 1), &lfh_count, &lfh_size );
+                group_size += block_size;
+                groups++;
+            }
+            else
+            {
+                used += block_size;
+                used_count++;
+            }
+        }
+    }
+
+    LIST_FOR_EACH_ENTRY( large, &heap->large_list, ARENA_LARGE, entry )
+    {
+        if (block_get_flags( &large->block ) & BLOCK_FLAG_LFH)
+        {
+            group_get_stats( (const struct group *)(&large->block + 1), &lfh_count, &lfh_size );
+            group_size += large->block_size;
+            groups++;
+        }
+        else
+        {
+            large_size += large->block_size;
+            large_count++;
+        }
+    }
+
+    TRACE_(heapstats)( "heap %p: flags %#lx, compat %lu, %u subheaps, reserved %#Ix, committed %#Ix\n", heap,
+                       heap->flags, ReadNoFence( &heap->compat_info ), subheap_count, reserved, committed );
+    TRACE_(heapstats)( "  used %#Ix in %Iu blocks, free %#Ix in %Iu blocks, largest free %#Ix\n",
+                       used, used_count, free, free_count, largest_free );
+    TRACE_(heapstats)( "  large %#Ix in %Iu blocks\n", large_size, large_count );
+    TRACE_(heapstats)( "  LFH used %#Ix in %Iu blocks, %Iu groups of total size %#Ix\n",
+                       lfh_size, lfh_count, groups, group_size );
+
+    for (i = 0; heap->bins && i < BLOCK_SIZE_BIN_COUNT; i++)
+    {
+        const struct bin *bin = heap->bins + i;
+        ULONG alloc = ReadNoFence( &bin->count_alloc ), freed = ReadNoFence( &bin->count_freed );
+        if (ReadNoFence( &bin->enabled )) enabled_count++;
+        if (!alloc && !freed) continue;
+        TRACE_(heapstats)( "  bin %3u: size %#6Ix, alloc %lu, freed %lu, LFH %s\n", i, BLOCK_BIN_SIZE( i ),
+                           alloc, freed, ReadNoFence( &bin->enabled ) ? "enabled" : "disabled" );
+    }
+    if (heap->bins) TRACE_(heapstats)( "  LFH enabled for %u bins\n", enabled_count );
+}
+
+/* dump the memory usage of all the process heaps */
+void heap_process_detach(void)
+{
+    struct heap *heap;
+
+    if (!TRACE_ON(heapstats)) return;
+
+    RtlEnterCriticalSection( &process_heap->cs );
+
+    LIST_FOR_EACH_ENTRY( heap, &process_heap->entry, struct heap, entry )
+    {
+        heap_lock( heap, 0 );
+        heap_dump_stats( heap );
+        heap_unlock( heap, 0 );
+    }
+
+    heap_dump_stats( process_heap );
+
+    RtlLeaveCriticalSection( &process_heap->cs );
+}
+
 /***********************************************************************
  *           RtlAllocateHeap   (NTDLL.@)
  */
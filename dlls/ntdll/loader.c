@@ -145,6 +145,10 @@ typedef struct _wine_modref
     struct file_id        id;
     ULONG                 CheckSum;
     BOOL                  system;
+    BOOL                  at_image_base;  /* loaded at the base address it was linked for */
+    ULONG                 export_lookups; /* number of exports looked up by name */
+    ULONG                 export_mask;    /* size of the export hash table minus one */
+    DWORD                *export_hash;    /* export name hash table, built on demand */
 } WINE_MODREF;
 
 static UINT tls_module_count = 32;     /* number of modules with TLS directory */
@@ -1082,6 +1086,75 @@ static int find_name_in_exports( HMODULE module, const IMAGE_EXPORT_DIRECTORY *e
 }
 
 
+/* number of lookups after which a module gets an export name hash table */
+#define EXPORT_HASH_THRESHOLD 32
+
+static ULONG hash_export_name( const char *name )
+{
+    ULONG hash = 2166136261u;
+
+    while (*name) hash = (hash ^ (unsigned char)*name++) * 16777619;
+    return hash;
+}
+
+
+/*************************************************************************
+ *		build_export_hash
+ *
+ * Build the export name hash table of a module. The table stores name
+ * indices plus one, zero marking empty slots.
+ */
+static void build_export_hash( WINE_MODREF *wm, const IMAGE_EXPORT_DIRECTORY *exports )
+{
+    const DWORD *names = get_rva( wm->ldr.DllBase, exports->AddressOfNames );
+    ULONG i, pos, mask = 15;
+
+    while (mask < 2 * exports->NumberOfNames) mask = mask * 2 + 1;
+    if (!(wm->export_hash = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY,
+                                             (mask + 1) * sizeof(*wm->export_hash) )))
+        return;
+    wm->export_mask = mask;
+
+    for (i = 0; i < exports->NumberOfNames; i++)
+    {
+        pos = hash_export_name( get_rva( wm->ldr.DllBase, names[i] ));
+        while (wm->export_hash[pos & mask]) pos++;
+        wm->export_hash[pos & mask] = i + 1;
+    }
+    TRACE( "built export hash for %s, %lu names\n", debugstr_w(wm->ldr.BaseDllName.Buffer),
+           exports->NumberOfNames );
+}
+
+
+/*************************************************************************
+ *		lookup_export_name
+ *
+ * Find the ordinal of an exported name, using the module export hash table
+ * for modules that have many lookups.
+ * The loader_section must be locked while calling this function.
+ */
+static int lookup_export_name( HMODULE module, const IMAGE_EXPORT_DIRECTORY *exports, const char *name )
+{
+    const WORD *ordinals = get_rva( module, exports->AddressOfNameOrdinals );
+    const DWORD *names = get_rva( module, exports->AddressOfNames );
+    WINE_MODREF *wm = get_modref( module );
+    ULONG pos, index;
+
+    if (!wm) return find_name_in_exports( module, exports, name );
+    if (!wm->export_hash)
+    {
+        if (++wm->export_lookups < EXPORT_HASH_THRESHOLD || exports->NumberOfNames < EXPORT_HASH_THRESHOLD)
+            return find_name_in_exports( module, exports, name );
+        build_export_hash( wm, exports );
+        if (!wm->export_hash) return find_name_in_exports( module, exports, name );
+    }
+
+    for (pos = hash_export_name( name ); (index = wm->export_hash[pos & wm->export_mask]); pos++)
+        if (!strcmp( get_rva( module, names[index - 1] ), name )) return ordinals[index - 1];
+    return -1;
+}
+
+
 /*************************************************************************
  *		find_named_export
  *
@@ -1104,8 +1177,8 @@ static FARPROC find_named_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *
             return find_ordinal_export( module, exports, exp_size, ordinals[hint], load_path, importer, is_dynamic );
     }
 
-    /* then do a binary search */
-    if ((ordinal = find_name_in_exports( module, exports, name )) == -1) return NULL;
+    /* then do a full lookup */
+    if ((ordinal = lookup_export_name( module, exports, name )) == -1) return NULL;
     return find_ordinal_export( module, exports, exp_size, ordinal, load_path, importer, is_dynamic );
 
 }
@@ -1138,6 +1211,42 @@ void * WINAPI RtlFindExportedRoutineByName( HMODULE module, const char *name )
 }
 
 
+/*************************************************************************
+ *		is_import_bound
+ *
+ * Check whether the import address table of a descriptor has been bound to the
+ * module that is actually loaded, in which case it can be used as is.
+ * Bindings that involve forwarded exports are always resolved again, since
+ * they require recording a dependency on the forwarded module.
+ */
+static BOOL is_import_bound( HMODULE module, const IMAGE_IMPORT_DESCRIPTOR *descr, const WINE_MODREF *imp )
+{
+    const IMAGE_BOUND_IMPORT_DESCRIPTOR *bound, *entry;
+    const char *name;
+    ULONG size, pos;
+
+    if (!descr->TimeDateStamp || !descr->OriginalFirstThunk) return FALSE;
+    if (!imp->at_image_base) return FALSE;
+
+    if (descr->TimeDateStamp != ~0u)  /* old style binding */
+        return descr->TimeDateStamp == imp->ldr.TimeDateStamp && descr->ForwarderChain == ~0u;
+
+    if (!(bound = RtlImageDirectoryEntryToData( module, TRUE, IMAGE_DIRECTORY_ENTRY_BOUND_IMPORT, &size )))
+        return FALSE;
+
+    name = get_rva( module, descr->Name );
+    for (pos = 0; pos + sizeof(*entry) <= size; pos += (entry->NumberOfModuleForwarderRefs + 1) * sizeof(*entry))
+    {
+        /* forwarder references have the same size as descriptors and follow them */
+        entry = (const IMAGE_BOUND_IMPORT_DESCRIPTOR *)((const char *)bound + pos);
+        if (!entry->OffsetModuleName || entry->OffsetModuleName >= size) break;
+        if (_stricmp( (const char *)bound + entry->OffsetModuleName, name )) continue;
+        return entry->TimeDateStamp == imp->ldr.TimeDateStamp && !entry->NumberOfModuleForwarderRefs;
+    }
+    return FALSE;
+}
+
+
 /*************************************************************************
  *		import_dll
  *
@@ -1189,6 +1298,13 @@ static BOOL import_dll( WINE_MODREF *wm, const IMAGE_IMPORT_DESCRIPTOR *descr, L
         return FALSE;
     }
 
+    if (is_import_bound( module, descr, wmImp ))
+    {
+        TRACE_(imports)( "using bound imports from %s\n", name );
+        *pwm = wmImp;
+        return TRUE;
+    }
+
     /* unprotect the import address table since it can be located in
      * readonly section */
     while (import_list[protect_size].u1.Ordinal) protect_size++;
@@ -2373,6 +2489,8 @@ static NTSTATUS build_module( LPCWSTR load_path, const UNICODE_STRING *nt_name,
     if (image_info->ComPlusILOnly) wm->ldr.Flags |= LDR_COR_ILONLY;
     if (redirected) wm->ldr.Flags |= LDR_REDIRECTED;
     wm->system = system;
+    wm->at_image_base = (*module == (void *)nt->OptionalHeader.ImageBase &&
+                         !image_info->ImageDynamicallyRelocated);
 
     update_load_config( *module );
 
@@ -4009,6 +4127,7 @@ void WINAPI LdrShutdownProcess(void)
         RtlProcessFlsData( NtCurrentTeb()->FlsSlots, 1 );
 
     process_detach();
+    heap_process_detach();
 }
 
 extern const char * CDECL wine_get_version(void);
@@ -4129,6 +4248,7 @@ static void free_modref( WINE_MODREF *wm )
                         (wm->ldr.Flags & LDR_WINE_INTERNAL) ? "builtin" : "native" );
 
     free_tls_slot( &wm->ldr );
+    RtlFreeHeap( GetProcessHeap(), 0, wm->export_hash );
     RtlReleaseActivationContext( wm->ldr.ActivationContext );
     NtUnmapViewOfSection( NtCurrentProcess(), wm->ldr.DllBase );
     if (cached_modref == wm) cached_modref = NULL;
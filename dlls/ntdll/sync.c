@@ -833,15 +833,26 @@ struct futex_queue
 {
     struct list queue;
     LONG lock;
+    LONG waiters;  /* number of entries in the queue, can be read without the lock */
 };
 
-static struct futex_queue futex_queues[256];
+static struct futex_queue futex_queues[1024];
 
 static struct futex_queue *get_futex_queue( const void *addr )
 {
     ULONG_PTR val = (ULONG_PTR)addr;
 
-    return &futex_queues[(val >> 4) % ARRAY_SIZE(futex_queues)];
+    /* mix the upper bits in, so that objects at page-sized strides don't share a queue */
+    val = (val >> 4) ^ (val >> 14) ^ (val >> 24);
+    return &futex_queues[val % ARRAY_SIZE(futex_queues)];
+}
+
+/* check whether a queue may have waiters; the caller has modified the address before */
+static BOOL futex_queue_has_waiters( struct futex_queue *queue )
+{
+    /* pairs with the interlocked increment in RtlWaitOnAddress() */
+    MemoryBarrier();
+    return ReadNoFence( &queue->waiters ) != 0;
 }
 
 static void spin_lock( LONG *lock )
@@ -892,10 +903,15 @@ NTSTATUS WINAPI RtlWaitOnAddress( const void *addr, const void *cmp, SIZE_T size
 
     spin_lock( &queue->lock );
 
+    /* Count ourselves before the comparison, so that a waker which modified the
+     * address either sees a waiter or we see the new value. */
+    InterlockedIncrement( &queue->waiters );
+
     /* Do the comparison inside of the spinlock, to reduce spurious wakeups. */
 
     if (!compare_addr( addr, cmp, size ))
     {
+        InterlockedDecrement( &queue->waiters );
         spin_unlock( &queue->lock );
         return STATUS_SUCCESS;
     }
@@ -913,7 +929,10 @@ NTSTATUS WINAPI RtlWaitOnAddress( const void *addr, const void *cmp, SIZE_T size
     {
         spin_lock( &queue->lock );
         if (entry.addr)
+        {
             list_remove( &entry.entry );
+            InterlockedDecrement( &queue->waiters );
+        }
         spin_unlock( &queue->lock );
     }
 
@@ -935,7 +954,7 @@ void WINAPI RtlWakeAddressAll( const void *addr )
 
     TRACE("%p\n", addr);
 
-    if (!addr) return;
+    if (!addr || !futex_queue_has_waiters( queue )) return;
 
     spin_lock( &queue->lock );
 
@@ -948,6 +967,7 @@ void WINAPI RtlWakeAddressAll( const void *addr )
         {
             entry->addr = NULL;
             list_remove( &entry->entry );
+            InterlockedDecrement( &queue->waiters );
             if (count == ARRAY_SIZE(tids))
             {
                 NtAlertMultipleThreadByThreadId( tids, count, NULL, NULL );
@@ -975,7 +995,7 @@ void WINAPI RtlWakeAddressSingle( const void *addr )
 
     TRACE("%p\n", addr);
 
-    if (!addr) return;
+    if (!addr || !futex_queue_has_waiters( queue )) return;
 
     spin_lock( &queue->lock );
 
@@ -995,6 +1015,7 @@ void WINAPI RtlWakeAddressSingle( const void *addr )
              * calls must wake at least two waiters if they exist. */
             entry->addr = NULL;
             list_remove( &entry->entry );
+            InterlockedDecrement( &queue->waiters );
             break;
         }
     }
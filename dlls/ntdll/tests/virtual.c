@@ -30,6 +30,7 @@
 static unsigned int page_size;
 
 static DWORD64 (WINAPI *pGetEnabledXStateFeatures)(void);
+static SIZE_T (WINAPI *pGetLargePageMinimum)(void);
 static NTSTATUS (WINAPI *pRtlCreateUserStack)(SIZE_T, SIZE_T, ULONG, SIZE_T, SIZE_T, INITIAL_TEB *);
 static NTSTATUS (WINAPI *pRtlCreateUserThread)(HANDLE, SECURITY_DESCRIPTOR*, BOOLEAN, ULONG, SIZE_T,
                                                SIZE_T, PRTL_THREAD_START_ROUTINE, void*, HANDLE*, CLIENT_ID* );
@@ -2543,6 +2544,130 @@ static void test_syscall_abi(void)
     if (prev_user_lcid) NtSetDefaultLocale( TRUE, prev_user_lcid );
 }
 
+static void test_NtAllocateVirtualMemory_large_pages(void)
+{
+    static const ULONG invalid_types[] =
+    {
+        MEM_RESERVE | MEM_LARGE_PAGES,
+        MEM_COMMIT | MEM_LARGE_PAGES,
+        MEM_LARGE_PAGES,
+    };
+    const KUSER_SHARED_DATA *user_shared_data = (void *)0x7ffe0000;
+    SIZE_T large_page_size, size;
+    MEMORY_BASIC_INFORMATION mbi;
+    BOOLEAN enabled, prev;
+    NTSTATUS status;
+    unsigned int i;
+    void *addr;
+
+    if (!pGetLargePageMinimum)
+    {
+        win_skip("GetLargePageMinimum is not available.\n");
+        return;
+    }
+
+    large_page_size = pGetLargePageMinimum();
+    ok(large_page_size == user_shared_data->LargePageMinimum, "got large page size %#Ix, expected %#lx.\n",
+       large_page_size, user_shared_data->LargePageMinimum);
+    if (!large_page_size)
+    {
+        skip("Large pages are not supported.\n");
+        return;
+    }
+    ok(!(large_page_size & (large_page_size - 1)), "large page size %#Ix is not a power of two.\n", large_page_size);
+    ok(!(large_page_size & 0xffff), "large page size %#Ix is not a multiple of the allocation granularity.\n",
+       large_page_size);
+
+    /* the size must be a multiple of the large page size */
+    addr = NULL;
+    size = large_page_size / 2;
+    status = NtAllocateVirtualMemory( NtCurrentProcess(), &addr, 0, &size,
+                                      MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+    ok(status == STATUS_INVALID_PARAMETER, "got %#lx.\n", status);
+    ok(!addr, "got %p.\n", addr);
+
+    addr = NULL;
+    size = large_page_size + 0x10000;
+    status = NtAllocateVirtualMemory( NtCurrentProcess(), &addr, 0, &size,
+                                      MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+    ok(status == STATUS_INVALID_PARAMETER, "got %#lx.\n", status);
+    ok(!addr, "got %p.\n", addr);
+
+    /* the memory must be reserved and committed at once */
+    for (i = 0; i < ARRAY_SIZE(invalid_types); i++)
+    {
+        winetest_push_context( "type %#lx", invalid_types[i] );
+        addr = NULL;
+        size = large_page_size;
+        status = NtAllocateVirtualMemory( NtCurrentProcess(), &addr, 0, &size, invalid_types[i], PAGE_READWRITE );
+        ok(status == STATUS_INVALID_PARAMETER, "got %#lx.\n", status);
+        ok(!addr, "got %p.\n", addr);
+        winetest_pop_context();
+    }
+
+    /* the privilege is only checked once the parameters are valid */
+    status = RtlAdjustPrivilege( SE_LOCK_MEMORY_PRIVILEGE, FALSE, FALSE, &enabled );
+    ok(!status || status == STATUS_PRIVILEGE_NOT_HELD, "got %#lx.\n", status);
+
+    addr = NULL;
+    size = large_page_size;
+    status = NtAllocateVirtualMemory( NtCurrentProcess(), &addr, 0, &size,
+                                      MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+    ok(status == STATUS_PRIVILEGE_NOT_HELD, "got %#lx.\n", status);
+    ok(!addr, "got %p.\n", addr);
+
+    status = RtlAdjustPrivilege( SE_LOCK_MEMORY_PRIVILEGE, TRUE, FALSE, &prev );
+    if (status)
+    {
+        ok(status == STATUS_PRIVILEGE_NOT_HELD, "got %#lx.\n", status);
+        skip("SeLockMemoryPrivilege is not held.\n");
+        return;
+    }
+
+    addr = NULL;
+    size = large_page_size;
+    status = NtAllocateVirtualMemory( NtCurrentProcess(), &addr, 0, &size,
+                                      MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+    if (status == STATUS_NO_MEMORY || status == STATUS_INSUFFICIENT_RESOURCES)
+    {
+        skip("No large pages available.\n");
+        RtlAdjustPrivilege( SE_LOCK_MEMORY_PRIVILEGE, enabled, FALSE, &prev );
+        return;
+    }
+    ok(!status, "got %#lx.\n", status);
+    ok(!((ULONG_PTR)addr & (large_page_size - 1)), "got unaligned address %p.\n", addr);
+    ok(size == large_page_size, "got size %#Ix.\n", size);
+    memset( addr, 0xcc, size );
+
+    status = NtQueryVirtualMemory( NtCurrentProcess(), addr, MemoryBasicInformation, &mbi, sizeof(mbi), NULL );
+    ok(!status, "got %#lx.\n", status);
+    ok(mbi.AllocationBase == addr, "got %p, expected %p.\n", mbi.AllocationBase, addr);
+    ok(mbi.RegionSize == large_page_size, "got %#Ix.\n", mbi.RegionSize);
+    ok(mbi.State == MEM_COMMIT, "got %#lx.\n", mbi.State);
+    ok(mbi.Protect == PAGE_READWRITE, "got %#lx.\n", mbi.Protect);
+    ok(mbi.Type == MEM_PRIVATE, "got %#lx.\n", mbi.Type);
+
+    size = 0;
+    status = NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
+    ok(!status, "got %#lx.\n", status);
+
+    addr = NULL;
+    size = 2 * large_page_size;
+    status = NtAllocateVirtualMemory( NtCurrentProcess(), &addr, 0, &size,
+                                      MEM_RESERVE | MEM_COMMIT | MEM_TOP_DOWN | MEM_LARGE_PAGES, PAGE_READWRITE );
+    ok(!status || broken(status == STATUS_INSUFFICIENT_RESOURCES), "got %#lx.\n", status);
+    if (!status)
+    {
+        ok(!((ULONG_PTR)addr & (large_page_size - 1)), "got unaligned address %p.\n", addr);
+        ok(size == 2 * large_page_size, "got size %#Ix.\n", size);
+        size = 0;
+        status = NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
+        ok(!status, "got %#lx.\n", status);
+    }
+
+    RtlAdjustPrivilege( SE_LOCK_MEMORY_PRIVILEGE, enabled, FALSE, &prev );
+}
+
 static void test_NtFreeVirtualMemory(void)
 {
     void *addr1, *addr;
@@ -3577,6 +3702,7 @@ START_TEST(virtual)
     mod = GetModuleHandleA("kernel32.dll");
     pIsWow64Process = (void *)GetProcAddress(mod, "IsWow64Process");
     pGetEnabledXStateFeatures = (void *)GetProcAddress(mod, "GetEnabledXStateFeatures");
+    pGetLargePageMinimum = (void *)GetProcAddress(mod, "GetLargePageMinimum");
     mod = GetModuleHandleA("ntdll.dll");
     pRtlCreateUserStack = (void *)GetProcAddress(mod, "RtlCreateUserStack");
     pRtlCreateUserThread = (void *)GetProcAddress(mod, "RtlCreateUserThread");
@@ -3602,6 +3728,7 @@ START_TEST(virtual)
     test_NtAllocateVirtualMemory();
     test_NtAllocateVirtualMemoryEx();
     test_NtAllocateVirtualMemoryEx_address_requirements();
+    test_NtAllocateVirtualMemory_large_pages();
     test_NtFreeVirtualMemory();
     test_NtProtectVirtualMemory();
     test_RtlCreateUserStack();
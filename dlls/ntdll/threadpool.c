@@ -96,6 +96,8 @@ struct timer_queue
  */
 
 #define THREADPOOL_WORKER_TIMEOUT 5000
+/* the pool lock is only held for short list operations, spin before blocking */
+#define THREADPOOL_LOCK_SPIN_COUNT 4000
 #define MAXIMUM_WAITQUEUE_OBJECTS (MAXIMUM_WAIT_OBJECTS - 1)
 
 /* internal threadpool representation */
@@ -1769,7 +1771,7 @@ static NTSTATUS tp_threadpool_alloc( struct threadpool **out )
     pool->objcount              = 0;
     pool->shutdown              = FALSE;
 
-    RtlInitializeCriticalSectionEx( &pool->cs, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO );
+    RtlInitializeCriticalSectionEx( &pool->cs, THREADPOOL_LOCK_SPIN_COUNT, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO );
     pool->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": threadpool.cs");
 
     for (i = 0; i < ARRAY_SIZE(pool->pools); ++i)
@@ -2098,14 +2100,13 @@ static void tp_object_submit( struct threadpool_object *object, BOOL signaled )
     if (object->type == TP_OBJECT_TYPE_WAIT && signaled)
         object->u.wait.signaled++;
 
-    /* No new thread started - wake up one existing thread. */
+    assert( status == STATUS_SUCCESS || pool->num_workers > 0 );
+    RtlLeaveCriticalSection( &pool->cs );
+
+    /* No new thread started - wake up one existing thread. This is done
+     * after releasing the lock, so that it doesn't immediately block on it. */
     if (status != STATUS_SUCCESS)
-    {
-        assert( pool->num_workers > 0 );
         RtlWakeConditionVariable( &pool->update_event );
-    }
-
-    RtlLeaveCriticalSection( &pool->cs );
 }
 
 /***********************************************************************
@@ -2466,9 +2466,14 @@ static NTSTATUS get_dir_data_entry( struct dir_data *dir_data, void *info_ptr, I
     const struct dir_data_names *names = &dir_data->names[dir_data->pos];
     union file_directory_info *info;
     struct stat st;
-    ULONG name_len, start, dir_size, attributes, reparse_tag;
+    ULONG name_len, start, dir_size, attributes = 0, reparse_tag = 0;
+    int ret;
+
+    /* attributes and reparse tags are not needed for names only, skip the extended attributes lookups */
+    if (class == FileNamesInformation) ret = stat( names->unix_name, &st );
+    else ret = get_file_info( names->unix_name, &st, &attributes, &reparse_tag );
 
-    if (get_file_info( names->unix_name, &st, &attributes, &reparse_tag ) == -1)
+    if (ret == -1)
     {
         TRACE( "file no longer exists %s\n", debugstr_a(names->unix_name) );
         return STATUS_SUCCESS;
@@ -2988,6 +2993,182 @@ NTSTATUS WINAPI NtQueryDirectoryFile( HANDLE handle, HANDLE event, PIO_APC_ROUTI
 }
 
 
+/* cache of directory contents for case-insensitive lookups */
+struct dir_case_cache
+{
+    dev_t         dev;     /* directory device */
+    ino_t         ino;     /* directory inode */
+    LONGLONG      mtime;   /* directory modification time when it was read */
+    unsigned int  mask;    /* size of the hash table minus one */
+    unsigned int *hash;    /* hash table of name offsets plus one */
+    char         *names;   /* null-terminated unix file names */
+};
+
+#define DIR_CASE_CACHE_SIZE 64
+
+static struct dir_case_cache *dir_case_cache[DIR_CASE_CACHE_SIZE];
+static pthread_mutex_t dir_case_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned int hash_dir_case_name( const WCHAR *name, int length )
+{
+    unsigned int hash = 0;
+
+    while (length--) hash = hash * 31 + towupper( *name++ );
+    return hash;
+}
+
+static LONGLONG get_dir_mtime( const struct stat *st )
+{
+    LARGE_INTEGER mtime, ctime, atime, creation;
+
+    get_file_times( st, &mtime, &ctime, &atime, &creation );
+    return mtime.QuadPart;
+}
+
+static void free_dir_case_cache( struct dir_case_cache *cache )
+{
+    if (!cache) return;
+    free( cache->hash );
+    free( cache->names );
+    free( cache );
+}
+
+
+/***********************************************************************
+ *           read_dir_case_cache
+ *
+ * Read the contents of a directory and build a case-insensitive hash table of its names.
+ */
+static struct dir_case_cache *read_dir_case_cache( int root_fd, const char *dir, const struct stat *st )
+{
+    WCHAR buffer[MAX_DIR_ENTRY_LEN];
+    struct dir_case_cache *cache;
+    unsigned int i, pos, count = 0, used = 0, size = 4096;
+    struct dirent *de;
+    DIR *dirp;
+    char *new_names;
+    int fd, len;
+
+    if ((fd = openat( root_fd, dir, O_RDONLY | O_DIRECTORY )) == -1) return NULL;
+    if (!(dirp = fdopendir( fd )))
+    {
+        close( fd );
+        return NULL;
+    }
+    if (!(cache = calloc( 1, sizeof(*cache) )) || !(cache->names = malloc( size ))) goto failed;
+
+    while ((de = readdir( dirp )))
+    {
+        len = strlen( de->d_name ) + 1;
+        if (used + len > size)
+        {
+            while (used + len > size) size *= 2;
+            if (!(new_names = realloc( cache->names, size ))) goto failed;
+            cache->names = new_names;
+        }
+        memcpy( cache->names + used, de->d_name, len );
+        used += len;
+        count++;
+    }
+    closedir( dirp );
+    dirp = NULL;
+
+    cache->mask = 15;
+    while (cache->mask < 2 * count) cache->mask = cache->mask * 2 + 1;
+    if (!(cache->hash = calloc( cache->mask + 1, sizeof(*cache->hash) ))) goto failed;
+
+    for (i = 0; i < used; i += len + 1)
+    {
+        len = strlen( cache->names + i );
+        pos = hash_dir_case_name( buffer, ntdll_umbstowcs( cache->names + i, len, buffer, MAX_DIR_ENTRY_LEN ));
+        while (cache->hash[pos & cache->mask]) pos++;
+        cache->hash[pos & cache->mask] = i + 1;
+    }
+
+    cache->dev = st->st_dev;
+    cache->ino = st->st_ino;
+    cache->mtime = get_dir_mtime( st );
+    return cache;
+
+failed:
+    if (dirp) closedir( dirp );
+    free_dir_case_cache( cache );
+    return NULL;
+}
+
+
+/***********************************************************************
+ *           lookup_dir_case_cache
+ */
+static NTSTATUS lookup_dir_case_cache( const struct dir_case_cache *cache, char *unix_name, int pos,
+                                       const WCHAR *name, int length )
+{
+    WCHAR buffer[MAX_DIR_ENTRY_LEN];
+    unsigned int hash, offset;
+    const char *entry;
+    int ret;
+
+    for (hash = hash_dir_case_name( name, length ); (offset = cache->hash[hash & cache->mask]); hash++)
+    {
+        entry = cache->names + offset - 1;
+        ret = ntdll_umbstowcs( entry, strlen(entry), buffer, MAX_DIR_ENTRY_LEN );
+        if (ret == length && !wcsnicmp( buffer, name, ret ))
+        {
+            unix_name[pos - 1] = '/';
+            strcpy( unix_name + pos, entry );
+            return STATUS_SUCCESS;
+        }
+    }
+    return STATUS_OBJECT_NAME_NOT_FOUND;
+}
+
+
+/***********************************************************************
+ *           find_file_in_dir_cache
+ *
+ * Case-insensitive search for a file through the cached directory contents.
+ * The cache entry is refreshed whenever the directory modification time changes.
+ * Directories modified within the last couple of seconds are not cached, since
+ * further changes could go unnoticed with a coarse timestamp granularity.
+ */
+static NTSTATUS find_file_in_dir_cache( int root_fd, char *unix_name, int pos, const WCHAR *name, int length )
+{
+    struct dir_case_cache *cache, *old;
+    struct stat st;
+    unsigned int slot;
+    NTSTATUS status;
+
+    if (fstatat( root_fd, unix_name, &st, 0 ) == -1) return errno_to_status( errno );
+    slot = (st.st_ino ^ st.st_dev) % DIR_CASE_CACHE_SIZE;
+
+    mutex_lock( &dir_case_mutex );
+    if ((cache = dir_case_cache[slot]) && cache->dev == st.st_dev && cache->ino == st.st_ino &&
+        cache->mtime == get_dir_mtime( &st ))
+    {
+        status = lookup_dir_case_cache( cache, unix_name, pos, name, length );
+        mutex_unlock( &dir_case_mutex );
+        return status;
+    }
+    mutex_unlock( &dir_case_mutex );
+
+    if (!(cache = read_dir_case_cache( root_fd, unix_name, &st ))) return STATUS_NO_MEMORY;
+    status = lookup_dir_case_cache( cache, unix_name, pos, name, length );
+
+    if (st.st_mtime >= time( NULL ) - 1)
+    {
+        free_dir_case_cache( cache );
+        return status;
+    }
+
+    mutex_lock( &dir_case_mutex );
+    old = dir_case_cache[slot];
+    dir_case_cache[slot] = cache;
+    mutex_unlock( &dir_case_mutex );
+    free_dir_case_cache( old );
+    return status;
+}
+
+
 /***********************************************************************
  *           find_file_in_dir
  *
@@ -3000,10 +3181,11 @@ static NTSTATUS find_file_in_dir( int root_fd, char *unix_name, int pos, const W
 {
     WCHAR buffer[MAX_DIR_ENTRY_LEN];
     BOOLEAN is_name_8_dot_3;
+    NTSTATUS status;
     DIR *dir;
     struct dirent *de;
     struct stat st;
-    int fd, ret;
+    int i, fd, ret;
 
     /* try a shortcut for this directory */
 
@@ -3028,6 +3210,18 @@ static NTSTATUS find_file_in_dir( int root_fd, char *unix_name, int pos, const W
 
     if (!is_name_8_dot_3 && !get_dir_case_sensitivity( root_fd, unix_name )) goto not_found;
 
+    /* look for the long name in the cached directory contents */
+
+    status = find_file_in_dir_cache( root_fd, unix_name, pos, name, length );
+    if (status == STATUS_SUCCESS) return status;
+    if (status == STATUS_OBJECT_NAME_NOT_FOUND)
+    {
+        /* only a short name can still match, and those always contain a tilde */
+        if (!is_name_8_dot_3) goto not_found;
+        for (i = 0; i < length; i++) if (name[i] == '~') break;
+        if (i == length) goto not_found;
+    }
+
     /* now look for it through the directory */
 
 #ifdef VFAT_IOCTL_READDIR_BOTH
@@ -1071,7 +1071,7 @@ union fd_cache_entry
 C_ASSERT( sizeof(union fd_cache_entry) == sizeof(LONG64) );
 
 #define FD_CACHE_BLOCK_SIZE  (65536 / sizeof(union fd_cache_entry))
-#define FD_CACHE_ENTRIES     128
+#define FD_CACHE_ENTRIES     (0x1000000 / FD_CACHE_BLOCK_SIZE)  /* enough for the server handle range */
 
 static union fd_cache_entry *fd_cache[FD_CACHE_ENTRIES];
 static union fd_cache_entry fd_cache_initial_block[FD_CACHE_BLOCK_SIZE];
@@ -1893,8 +1893,9 @@ NTSTATUS WINAPI NtDuplicateObject( HANDLE source_process, HANDLE source, HANDLE
                                    ACCESS_MASK access, ULONG attributes, ULONG options )
 {
     sigset_t sigset;
-    unsigned int ret;
-    int fd = -1;
+    unsigned int ret, fd_access, fd_options;
+    enum server_fd_type fd_type;
+    int fd = -1, cached_fd = -1;
 
     if (dest) *dest = 0;
 
@@ -1923,6 +1924,12 @@ NTSTATUS WINAPI NtDuplicateObject( HANDLE source_process, HANDLE source, HANDLE
      * call to remove_fd_from_cache and close_handle */
     server_enter_uninterrupted_section( &fd_cache_mutex, &sigset );
 
+    /* a duplicate with the same access in the current process can share the cached fd */
+    if (dest && source_process == NtCurrentProcess() && dest_process == NtCurrentProcess() &&
+        (options & DUPLICATE_SAME_ACCESS) &&
+        get_cached_fd( source, &cached_fd, &fd_type, &fd_access, &fd_options ))
+        cached_fd = -1;
+
     /* always remove the cached fd; if the server request fails we'll just
      * retrieve it again */
     if (options & DUPLICATE_CLOSE_SOURCE)
@@ -1930,6 +1937,7 @@ NTSTATUS WINAPI NtDuplicateObject( HANDLE source_process, HANDLE source, HANDLE
         fd = remove_fd_from_cache( source );
         close_inproc_sync( source );
     }
+    else if (cached_fd != -1) fd = dup( cached_fd );
 
     SERVER_START_REQ( dup_handle )
     {
@@ -1946,6 +1954,10 @@ NTSTATUS WINAPI NtDuplicateObject( HANDLE source_process, HANDLE source, HANDLE
     }
     SERVER_END_REQ;
 
+    if (!ret && cached_fd != -1 && fd != -1 &&
+        add_fd_to_cache( *dest, fd, fd_type, fd_access, fd_options ))
+        fd = -1;
+
     server_leave_uninterrupted_section( &fd_cache_mutex, &sigset );
 
     if (fd != -1) close( fd );
@@ -169,6 +169,7 @@ static const BYTE VIRTUAL_Win32Flags[16] =
 };
 
 static struct wine_rb_tree views_tree;
+static struct file_view *last_view;  /* last view found in the tree */
 static pthread_mutex_t virtual_mutex;
 pthread_key_t thread_data_key = 0;
 
@@ -248,6 +249,7 @@ static const size_t view_block_size = 0x100000;
 static void *preload_reserve_start;
 static void *preload_reserve_end;
 static BOOL force_exec_prot;  /* whether to force PROT_EXEC on all PROT_READ mmaps */
+static SIZE_T large_page_size = 2 * 1024 * 1024;  /* size of MEM_LARGE_PAGES pages */
 static BOOL enable_write_exceptions;  /* raise exception on writes to executable memory */
 
 struct range_entry
@@ -1446,6 +1448,21 @@ static void VIRTUAL_Dump(void)
 #endif
 
 
+/***********************************************************************
+ *           get_last_view
+ *
+ * Return the last view found if it contains the given address. virtual_mutex must be held by caller.
+ */
+static inline struct file_view *get_last_view( const void *addr )
+{
+    struct file_view *view = last_view;
+
+    if (!view || (const char *)view->base > (const char *)addr) return NULL;
+    if ((const char *)view->base + view->size <= (const char *)addr) return NULL;
+    return view;
+}
+
+
 /***********************************************************************
  *           find_view
  *
@@ -1461,17 +1478,26 @@ static void VIRTUAL_Dump(void)
 static struct file_view *find_view( const void *addr, size_t size )
 {
     struct wine_rb_entry *ptr = views_tree.root;
+    struct file_view *view;
 
     if ((const char *)addr + size < (const char *)addr) return NULL; /* overflow */
 
+    /* views don't overlap, so this is the only view that can contain addr */
+    if ((view = get_last_view( addr )))
+        return (const char *)view->base + view->size < (const char *)addr + size ? NULL : view;
+
     while (ptr)
     {
-        struct file_view *view = WINE_RB_ENTRY_VALUE( ptr, struct file_view, entry );
+        view = WINE_RB_ENTRY_VALUE( ptr, struct file_view, entry );
 
         if (view->base > addr) ptr = ptr->left;
         else if ((const char *)view->base + view->size <= (const char *)addr) ptr = ptr->right;
-        else if ((const char *)view->base + view->size < (const char *)addr + size) break;  /* size too large */
-        else return view;
+        else
+        {
+            last_view = view;
+            if ((const char *)view->base + view->size < (const char *)addr + size) break;  /* size too large */
+            return view;
+        }
     }
     return NULL;
 }
@@ -1677,6 +1703,7 @@ static void free_view( struct file_view *view )
  */
 static void unregister_view( struct file_view *view )
 {
+    if (view == last_view) last_view = NULL;
     free_ranges_remove_view( view );
     wine_rb_remove( &views_tree, &view->entry );
 }
@@ -2771,6 +2798,28 @@ static NTSTATUS map_pe_header( void *ptr, size_t size, size_t map_size, int fd,
     return STATUS_SUCCESS;  /* page protections will be updated later */
 }
 
+/***********************************************************************
+ *           get_large_page_size
+ *
+ * Return the size of the host transparent huge pages, if known.
+ */
+static SIZE_T get_large_page_size(void)
+{
+#ifdef __linux__
+    unsigned long size;
+    FILE *f;
+    int ret;
+
+    if ((f = fopen( "/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r" )))
+    {
+        ret = fscanf( f, "%lu", &size );
+        fclose( f );
+        if (ret == 1 && size > granularity_mask && !(size & (size - 1))) return size;
+    }
+#endif
+    return 2 * 1024 * 1024;
+}
+
 #ifdef _WIN64
 
 /***********************************************************************
@@ -3692,6 +3741,9 @@ void virtual_init(void)
 
     kernel_writewatch_init();
 
+    large_page_size = get_large_page_size();
+    TRACE( "large page size: %uk\n", (UINT)large_page_size / 1024 );
+
     if (preload_info && *preload_info)
         for (i = 0; (*preload_info)[i].size; i++)
             mmap_add_reserved_area( (*preload_info)[i].addr, (*preload_info)[i].size );
@@ -4517,7 +4569,7 @@ void virtual_init_user_shared_data(void)
     virtual_get_system_info( &info, FALSE );
 
     data->TickCountMultiplier   = 1 << 24;
-    data->LargePageMinimum      = 2 * 1024 * 1024;
+    data->LargePageMinimum      = large_page_size;
     data->SystemCall            = 1;
     data->NumberOfPhysicalPages = info.MmNumberOfPhysicalPages;
     data->NXSupportPolicy       = NX_SUPPORT_POLICY_OPTIN;
@@ -5138,6 +5190,32 @@ void virtual_set_large_address_space(void)
 }
 
 
+/***********************************************************************
+ *             has_lock_memory_privilege
+ *
+ * Check whether the current token has SeLockMemoryPrivilege enabled, as required for large pages.
+ */
+static BOOL has_lock_memory_privilege(void)
+{
+    PRIVILEGE_SET privs;
+    BOOLEAN ret = FALSE;
+    HANDLE token;
+
+    if (NtOpenThreadTokenEx( GetCurrentThread(), TOKEN_QUERY, TRUE, 0, &token ) &&
+        NtOpenProcessTokenEx( NtCurrentProcess(), TOKEN_QUERY, 0, &token ))
+        return FALSE;
+
+    privs.PrivilegeCount = 1;
+    privs.Control = PRIVILEGE_SET_ALL_NECESSARY;
+    privs.Privilege[0].Luid.LowPart = SE_LOCK_MEMORY_PRIVILEGE;
+    privs.Privilege[0].Luid.HighPart = 0;
+    privs.Privilege[0].Attributes = 0;
+    if (NtPrivilegeCheck( token, &privs, &ret )) ret = FALSE;
+    NtClose( token );
+    return ret;
+}
+
+
 /***********************************************************************
  *             allocate_virtual_memory
  *
@@ -5195,6 +5273,16 @@ static NTSTATUS allocate_virtual_memory( void **ret, SIZE_T *size_ptr, ULONG typ
     if (type & MEM_RESERVE_PLACEHOLDER && (protect != PAGE_NOACCESS)) return STATUS_INVALID_PARAMETER;
     if (!arm64ec_view && (attributes & MEM_EXTENDED_PARAMETER_EC_CODE)) return STATUS_INVALID_PARAMETER;
 
+    if (type & MEM_LARGE_PAGES)
+    {
+        /* large pages must be reserved and committed at once, in multiples of the large page size */
+        if ((type & (MEM_RESERVE | MEM_COMMIT)) != (MEM_RESERVE | MEM_COMMIT)) return STATUS_INVALID_PARAMETER;
+        if (type & (MEM_WRITE_WATCH | MEM_RESERVE_PLACEHOLDER)) return STATUS_INVALID_PARAMETER;
+        if ((size | (UINT_PTR)base) & (large_page_size - 1)) return STATUS_INVALID_PARAMETER;
+        if (!has_lock_memory_privilege()) return STATUS_PRIVILEGE_NOT_HELD;
+        if (align < large_page_size) align = large_page_size;
+    }
+
     /* Reserve the memory */
 
     server_enter_uninterrupted_section( &virtual_mutex, &sigset );
@@ -5217,6 +5305,9 @@ static NTSTATUS allocate_virtual_memory( void **ret, SIZE_T *size_ptr, ULONG typ
             {
                 base = view->base;
                 if (vprot & VPROT_EXEC || force_exec_prot) mprotect_range( base, size, 0, 0 );
+#ifdef MADV_HUGEPAGE
+                if (type & MEM_LARGE_PAGES) madvise( base, size, MADV_HUGEPAGE );
+#endif
             }
         }
     }
@@ -5272,7 +5363,8 @@ static NTSTATUS allocate_virtual_memory( void **ret, SIZE_T *size_ptr, ULONG typ
 NTSTATUS WINAPI NtAllocateVirtualMemory( HANDLE process, PVOID *ret, ULONG_PTR zero_bits,
                                          SIZE_T *size_ptr, ULONG type, ULONG protect )
 {
-    static const ULONG type_mask = MEM_COMMIT | MEM_RESERVE | MEM_TOP_DOWN | MEM_WRITE_WATCH | MEM_RESET;
+    static const ULONG type_mask = MEM_COMMIT | MEM_RESERVE | MEM_TOP_DOWN | MEM_WRITE_WATCH | MEM_RESET
+                                   | MEM_LARGE_PAGES;
     ULONG_PTR limit;
 
     TRACE("%p %p %08lx %x %08x\n", process, *ret, *size_ptr, type, protect );
@@ -5412,7 +5504,8 @@ NTSTATUS WINAPI NtAllocateVirtualMemoryEx( HANDLE process, PVOID *ret, SIZE_T *s
                                            ULONG count )
 {
     static const ULONG type_mask = MEM_COMMIT | MEM_RESERVE | MEM_TOP_DOWN | MEM_WRITE_WATCH
-                                   | MEM_RESET | MEM_RESERVE_PLACEHOLDER | MEM_REPLACE_PLACEHOLDER;
+                                   | MEM_RESET | MEM_RESERVE_PLACEHOLDER | MEM_REPLACE_PLACEHOLDER
+                                   | MEM_LARGE_PAGES;
     ULONG_PTR limit_low = 0;
     ULONG_PTR limit_high = 0;
     ULONG_PTR align = 0;
@@ -5641,6 +5734,14 @@ static struct file_view *get_memory_region_size( char *base, char **region_start
     struct file_view *view;
 
     *fake_reserved = FALSE;
+
+    if ((view = get_last_view( base )))
+    {
+        *region_start = view->base;
+        *region_end = (char *)view->base + view->size;
+        return view;
+    }
+
     *region_start = NULL;
     *region_end = working_set_limit;
 
@@ -5662,6 +5763,7 @@ static struct file_view *get_memory_region_size( char *base, char **region_start
         {
             *region_start = view->base;
             *region_end = (char *)view->base + view->size;
+            last_view = view;
             return view;
         }
     }
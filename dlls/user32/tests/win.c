@@ -13435,6 +13435,179 @@ static void test_other_process_window(const char *argv0)
     DestroyWindow(hwnd);
 }
 
+static void window_styles_proc(HWND hwnd)
+{
+    HANDLE ready_event, done_event;
+    LONG style, exstyle;
+    DWORD ret;
+
+    ready_event = OpenEventA(EVENT_ALL_ACCESS, FALSE, "test_ws_ready");
+    ok(!!ready_event, "OpenEvent failed.\n");
+    done_event = OpenEventA(EVENT_ALL_ACCESS, FALSE, "test_ws_done");
+    ok(!!done_event, "OpenEvent failed.\n");
+
+    /* initial styles */
+    ret = WaitForSingleObject(ready_event, 5000);
+    ok(ret == WAIT_OBJECT_0, "Unexpected ret %lx.\n", ret);
+    style = GetWindowLongA(hwnd, GWL_STYLE);
+    exstyle = GetWindowLongA(hwnd, GWL_EXSTYLE);
+    ok(style & WS_POPUP, "Unexpected style %#lx.\n", style);
+    ok(!(style & (WS_VISIBLE | WS_DISABLED | WS_BORDER)), "Unexpected style %#lx.\n", style);
+    ok(exstyle & WS_EX_TOOLWINDOW, "Unexpected exstyle %#lx.\n", exstyle);
+    ok(!(exstyle & WS_EX_ACCEPTFILES), "Unexpected exstyle %#lx.\n", exstyle);
+    SetEvent(done_event);
+
+    /* ShowWindow */
+    ret = WaitForSingleObject(ready_event, 5000);
+    ok(ret == WAIT_OBJECT_0, "Unexpected ret %lx.\n", ret);
+    style = GetWindowLongA(hwnd, GWL_STYLE);
+    ok(style & WS_VISIBLE, "Unexpected style %#lx.\n", style);
+    ok(IsWindowVisible(hwnd), "Window should be visible.\n");
+    SetEvent(done_event);
+
+    /* EnableWindow */
+    ret = WaitForSingleObject(ready_event, 5000);
+    ok(ret == WAIT_OBJECT_0, "Unexpected ret %lx.\n", ret);
+    style = GetWindowLongA(hwnd, GWL_STYLE);
+    ok(style & WS_DISABLED, "Unexpected style %#lx.\n", style);
+    ok(!IsWindowEnabled(hwnd), "Window should be disabled.\n");
+    SetEvent(done_event);
+
+    /* SetWindowLong */
+    ret = WaitForSingleObject(ready_event, 5000);
+    ok(ret == WAIT_OBJECT_0, "Unexpected ret %lx.\n", ret);
+    style = GetWindowLongA(hwnd, GWL_STYLE);
+    exstyle = GetWindowLongA(hwnd, GWL_EXSTYLE);
+    ok(style & WS_BORDER, "Unexpected style %#lx.\n", style);
+    ok(exstyle & WS_EX_ACCEPTFILES, "Unexpected exstyle %#lx.\n", exstyle);
+    ok(exstyle & WS_EX_TOOLWINDOW, "Unexpected exstyle %#lx.\n", exstyle);
+
+    /* modify the styles from this process */
+    EnableWindow(hwnd, TRUE);
+    SetWindowLongA(hwnd, GWL_EXSTYLE, exstyle & ~WS_EX_ACCEPTFILES);
+    style = GetWindowLongA(hwnd, GWL_STYLE);
+    exstyle = GetWindowLongA(hwnd, GWL_EXSTYLE);
+    ok(!(style & WS_DISABLED), "Unexpected style %#lx.\n", style);
+    ok(!(exstyle & WS_EX_ACCEPTFILES), "Unexpected exstyle %#lx.\n", exstyle);
+    SetEvent(done_event);
+
+    /* hidden again */
+    ret = WaitForSingleObject(ready_event, 5000);
+    ok(ret == WAIT_OBJECT_0, "Unexpected ret %lx.\n", ret);
+    style = GetWindowLongA(hwnd, GWL_STYLE);
+    ok(!(style & WS_VISIBLE), "Unexpected style %#lx.\n", style);
+    SetEvent(done_event);
+
+    CloseHandle(ready_event);
+    CloseHandle(done_event);
+}
+
+static DWORD CALLBACK window_styles_thread(void *arg)
+{
+    HWND hwnd = arg;
+    LONG style, exstyle;
+
+    style = GetWindowLongA(hwnd, GWL_STYLE);
+    exstyle = GetWindowLongA(hwnd, GWL_EXSTYLE);
+    ok(style & WS_VISIBLE, "Unexpected style %#lx.\n", style);
+    ok(exstyle & WS_EX_TOOLWINDOW, "Unexpected exstyle %#lx.\n", exstyle);
+
+    EnableWindow(hwnd, FALSE);
+    SetWindowLongA(hwnd, GWL_STYLE, GetWindowLongA(hwnd, GWL_STYLE) | WS_BORDER);
+    SetWindowLongA(hwnd, GWL_EXSTYLE, GetWindowLongA(hwnd, GWL_EXSTYLE) | WS_EX_ACCEPTFILES);
+    ShowWindow(hwnd, SW_HIDE);
+
+    style = GetWindowLongA(hwnd, GWL_STYLE);
+    exstyle = GetWindowLongA(hwnd, GWL_EXSTYLE);
+    ok((style & (WS_VISIBLE | WS_DISABLED | WS_BORDER)) == (WS_DISABLED | WS_BORDER),
+       "Unexpected style %#lx.\n", style);
+    ok(exstyle & WS_EX_ACCEPTFILES, "Unexpected exstyle %#lx.\n", exstyle);
+    return 0;
+}
+
+static void test_window_styles_other_thread_process(const char *argv0)
+{
+    HANDLE ready_event, done_event, thread;
+    PROCESS_INFORMATION info;
+    STARTUPINFOA startup;
+    char cmd[MAX_PATH];
+    LONG style, exstyle;
+    HWND hwnd;
+    DWORD ret;
+
+    /* modifications from another thread */
+
+    hwnd = CreateWindowExA(WS_EX_TOOLWINDOW, "static", NULL, WS_POPUP | WS_VISIBLE,
+                           100, 100, 100, 100, 0, 0, NULL, NULL);
+    ok(!!hwnd, "CreateWindowEx failed.\n");
+    flush_events(TRUE);
+
+    thread = CreateThread(NULL, 0, window_styles_thread, hwnd, 0, NULL);
+    ret = wait_for_events(1, &thread, 5000);
+    ok(ret == WAIT_OBJECT_0, "Unexpected ret %lx.\n", ret);
+    CloseHandle(thread);
+
+    style = GetWindowLongA(hwnd, GWL_STYLE);
+    exstyle = GetWindowLongA(hwnd, GWL_EXSTYLE);
+    ok((style & (WS_VISIBLE | WS_DISABLED | WS_BORDER)) == (WS_DISABLED | WS_BORDER),
+       "Unexpected style %#lx.\n", style);
+    ok(exstyle & WS_EX_ACCEPTFILES, "Unexpected exstyle %#lx.\n", exstyle);
+    DestroyWindow(hwnd);
+
+    /* modifications seen from another process */
+
+    hwnd = CreateWindowExA(WS_EX_TOOLWINDOW, "static", NULL, WS_POPUP,
+                           100, 100, 100, 100, 0, 0, NULL, NULL);
+    ok(!!hwnd, "CreateWindowEx failed.\n");
+
+    ready_event = CreateEventA(NULL, FALSE, FALSE, "test_ws_ready");
+    ok(!!ready_event, "CreateEvent failed.\n");
+    done_event = CreateEventA(NULL, FALSE, FALSE, "test_ws_done");
+    ok(!!done_event, "CreateEvent failed.\n");
+
+    sprintf(cmd, "%s win window_styles %p", argv0, hwnd);
+    memset(&startup, 0, sizeof(startup));
+    startup.cb = sizeof(startup);
+    ok(CreateProcessA(NULL, cmd, NULL, NULL, FALSE, 0, NULL, NULL,
+                      &startup, &info), "CreateProcess failed.\n");
+
+    SetEvent(ready_event);
+    ret = wait_for_events(1, &done_event, 5000);
+    ok(ret == WAIT_OBJECT_0, "Unexpected ret %lx.\n", ret);
+
+    ShowWindow(hwnd, SW_SHOWNOACTIVATE);
+    SetEvent(ready_event);
+    ret = wait_for_events(1, &done_event, 5000);
+    ok(ret == WAIT_OBJECT_0, "Unexpected ret %lx.\n", ret);
+
+    EnableWindow(hwnd, FALSE);
+    SetEvent(ready_event);
+    ret = wait_for_events(1, &done_event, 5000);
+    ok(ret == WAIT_OBJECT_0, "Unexpected ret %lx.\n", ret);
+
+    SetWindowLongA(hwnd, GWL_STYLE, GetWindowLongA(hwnd, GWL_STYLE) | WS_BORDER);
+    SetWindowLongA(hwnd, GWL_EXSTYLE, GetWindowLongA(hwnd, GWL_EXSTYLE) | WS_EX_ACCEPTFILES);
+    SetEvent(ready_event);
+    ret = wait_for_events(1, &done_event, 5000);
+    ok(ret == WAIT_OBJECT_0, "Unexpected ret %lx.\n", ret);
+
+    /* the other process enabled the window and removed WS_EX_ACCEPTFILES */
+    style = GetWindowLongA(hwnd, GWL_STYLE);
+    exstyle = GetWindowLongA(hwnd, GWL_EXSTYLE);
+    ok(!(style & WS_DISABLED), "Unexpected style %#lx.\n", style);
+    ok(!(exstyle & WS_EX_ACCEPTFILES), "Unexpected exstyle %#lx.\n", exstyle);
+
+    ShowWindow(hwnd, SW_HIDE);
+    SetEvent(ready_event);
+    ret = wait_for_events(1, &done_event, 5000);
+    ok(ret == WAIT_OBJECT_0, "Unexpected ret %lx.\n", ret);
+
+    wait_child_process(&info);
+    CloseHandle(ready_event);
+    CloseHandle(done_event);
+    DestroyWindow(hwnd);
+}
+
 static void test_cancel_mode(void)
 {
     HWND hwnd1, hwnd2, child;
@@ -14529,6 +14702,11 @@ START_TEST(win)
             other_process_proc(hwnd);
             return;
         }
+        else if (!strcmp(argv[2], "window_styles"))
+        {
+            window_styles_proc(hwnd);
+            return;
+        }
     }
 
     if (argc == 3 && !strcmp(argv[2], "winproc_limit"))
@@ -14680,6 +14858,7 @@ START_TEST(win)
     test_window_placement();
     test_arrange_iconic_windows();
     test_other_process_window(argv[0]);
+    test_window_styles_other_thread_process(argv[0]);
     test_SC_SIZE();
     test_cancel_mode();
     test_DragDetect();
@@ -1198,6 +1198,26 @@ static DWORD calc_1d_stretch_params( INT dst_start, INT dst_length, INT dst_vis_
 }
 
 
+/* row function for when there is no horizontal scaling */
+static void copy_row( const dib_info *dst_dib, const POINT *dst_start,
+                      const dib_info *src_dib, const POINT *src_start,
+                      const struct stretch_params *params, int mode, BOOL keep_dst )
+{
+    RECT rect;
+
+    if (keep_dst && mode != STRETCH_DELETESCANS)
+    {
+        dst_dib->funcs->stretch_row( dst_dib, dst_start, src_dib, src_start, params, mode, keep_dst );
+        return;
+    }
+
+    rect.left   = dst_start->x;
+    rect.top    = dst_start->y;
+    rect.right  = dst_start->x + params->length;
+    rect.bottom = dst_start->y + 1;
+    dst_dib->funcs->copy_rect( dst_dib, &rect, src_dib, src_start, R2_COPYPEN, 0 );
+}
+
 DWORD stretch_bitmapinfo( const BITMAPINFO *src_info, void *src_bits, struct bitblt_coords *src,
                           const BITMAPINFO *dst_info, void *dst_bits, struct bitblt_coords *dst,
                           INT mode )
@@ -1254,6 +1274,10 @@ DWORD stretch_bitmapinfo( const BITMAPINFO *src_info, void *src_bits, struct bit
     err = v_params.err_start;
 
     row_fn = hstretch ? dst_dib.funcs->stretch_row : dst_dib.funcs->shrink_row;
+    /* same width and direction, each source pixel maps to exactly one destination pixel */
+    if (hstretch && !h_params.err_add_1 && h_params.err_start > 0 &&
+        h_params.src_inc == 1 && h_params.dst_inc == 1)
+        row_fn = copy_row;
 
     if (vstretch)
     {
@@ -47,6 +47,9 @@ enum glyph_type
 #define GLYPH_CACHE_PAGE_SIZE  0x100
 #define GLYPH_CACHE_PAGES      (0x10000 / GLYPH_CACHE_PAGE_SIZE)
 
+/* unused fonts are kept around until the cache grows larger than this */
+#define FONT_CACHE_MAX_SIZE    (4 * 1024 * 1024)
+
 struct cached_font
 {
     struct list           entry;
@@ -55,10 +58,12 @@ struct cached_font
     LOGFONTW              lf;
     XFORM                 xform;
     UINT                  aa_flags;
+    LONG                  size;    /* memory used by the font and its glyphs */
     struct cached_glyph **glyphs[GLYPH_NBTYPES][GLYPH_CACHE_PAGES];
 };
 
 static struct list font_cache = LIST_INIT( font_cache );
+static LONG font_cache_size;  /* memory used by all the cached fonts */
 
 static pthread_mutex_t font_cache_lock = PTHREAD_MUTEX_INITIALIZER;
 
@@ -585,9 +590,12 @@ static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
         }
     }
 
-    if (i > 5)  /* keep at least 5 of the most-recently used fonts around */
+    /* keep at least 5 of the most-recently used fonts around, and more while the cache is small */
+    if (i > 5 && font_cache_size > FONT_CACHE_MAX_SIZE)
     {
         ptr = last_unused;
+        TRACE( "evicting %p, %d bytes of %d\n", ptr, ptr->size, font_cache_size );
+        InterlockedExchangeAdd( &font_cache_size, (LONG)sizeof(*ptr) - ptr->size );
         for (i = 0; i < GLYPH_NBTYPES; i++)
         {
             for (j = 0; j < GLYPH_CACHE_PAGES; j++)
@@ -605,9 +613,11 @@ static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
         pthread_mutex_unlock( &font_cache_lock );
         return NULL;
     }
+    else InterlockedExchangeAdd( &font_cache_size, sizeof(*ptr) );
 
     *ptr = font;
     ptr->ref = 1;
+    ptr->size = sizeof(*ptr);
     memset( ptr->glyphs, 0, sizeof(ptr->glyphs) );
 done:
     list_add_head( &font_cache, &ptr->entry );
@@ -622,7 +632,7 @@ void release_cached_font( struct cached_font *font )
 }
 
 static struct cached_glyph *add_cached_glyph( struct cached_font *font, UINT index, UINT flags,
-                                              struct cached_glyph *glyph )
+                                              struct cached_glyph *glyph, UINT size )
 {
     struct cached_glyph *ret;
     enum glyph_type type = (flags & ETO_GLYPH_INDEX) ? GLYPH_INDEX : GLYPH_WCHAR;
@@ -641,9 +651,20 @@ static struct cached_glyph *add_cached_glyph( struct cached_font *font, UINT ind
         }
         if (InterlockedCompareExchangePointer( (void **)&font->glyphs[type][page], ptr, NULL ))
             free( ptr );
+        else
+        {
+            /* the page stays in the cache even if we lose the race for the glyph below */
+            InterlockedExchangeAdd( &font->size, GLYPH_CACHE_PAGE_SIZE * sizeof(*ptr) );
+            InterlockedExchangeAdd( &font_cache_size, GLYPH_CACHE_PAGE_SIZE * sizeof(*ptr) );
+        }
     }
     ret = InterlockedCompareExchangePointer( (void **)&font->glyphs[type][page][entry], glyph, NULL );
-    if (!ret) ret = glyph;
+    if (!ret)
+    {
+        InterlockedExchangeAdd( &font->size, size );
+        InterlockedExchangeAdd( &font_cache_size, size );
+        ret = glyph;
+    }
     else free( glyph );
     return ret;
 }
@@ -804,7 +825,7 @@ static struct cached_glyph *cache_glyph_bitmap( DC *dc, struct cached_font *font
 
 done:
     glyph->metrics = metrics;
-    return add_cached_glyph( font, index, flags, glyph );
+    return add_cached_glyph( font, index, flags, glyph, FIELD_OFFSET( struct cached_glyph, bits[size] ));
 }
 
 static void render_string( DC *dc, dib_info *dib, struct cached_font *font, INT x, INT y,
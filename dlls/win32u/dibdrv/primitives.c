@@ -4640,28 +4640,34 @@ static inline DWORD blend_argb_no_src_alpha( DWORD dst, DWORD src, DWORD alpha )
             blend_color( dst >> 24, 255, alpha ) << 24);
 }
 
+/* divide two packed 16-bit values by 255, exact for values up to 0xff00 */
+static inline DWORD div255_pair( DWORD val )
+{
+    return ((val + ((val >> 8) & 0x00ff00ff) + 0x00010001) >> 8) & 0x00ff00ff;
+}
+
 static inline DWORD blend_argb( DWORD dst, DWORD src )
 {
-    BYTE b = (BYTE)src;
-    BYTE g = (BYTE)(src >> 8);
-    BYTE r = (BYTE)(src >> 16);
-    DWORD alpha  = (BYTE)(src >> 24);
-    return ((b     + ((BYTE)dst         * (255 - alpha) + 127) / 255) |
-            (g     + ((BYTE)(dst >> 8)  * (255 - alpha) + 127) / 255) << 8 |
-            (r     + ((BYTE)(dst >> 16) * (255 - alpha) + 127) / 255) << 16 |
-            (alpha + ((BYTE)(dst >> 24) * (255 - alpha) + 127) / 255) << 24);
+    DWORD alpha = src >> 24;
+    DWORD rb, ag;
+
+    if (alpha == 255) return src;
+    if (!src) return dst;
+
+    /* scale blue/red and green/alpha in pairs */
+    rb = div255_pair( (dst & 0x00ff00ff) * (255 - alpha) + 0x007f007f );
+    ag = div255_pair( ((dst >> 8) & 0x00ff00ff) * (255 - alpha) + 0x007f007f );
+    return (((BYTE)src         + (BYTE)rb) |
+            ((BYTE)(src >> 8)  + (BYTE)ag) << 8 |
+            ((BYTE)(src >> 16) + (rb >> 16)) << 16 |
+            (alpha             + (ag >> 16)) << 24);
 }
 
 static inline DWORD blend_argb_alpha( DWORD dst, DWORD src, DWORD alpha )
 {
-    BYTE b = ((BYTE)src         * alpha + 127) / 255;
-    BYTE g = ((BYTE)(src >> 8)  * alpha + 127) / 255;
-    BYTE r = ((BYTE)(src >> 16) * alpha + 127) / 255;
-    alpha  = ((BYTE)(src >> 24) * alpha + 127) / 255;
-    return ((b     + ((BYTE)dst         * (255 - alpha) + 127) / 255) |
-            (g     + ((BYTE)(dst >> 8)  * (255 - alpha) + 127) / 255) << 8 |
-            (r     + ((BYTE)(dst >> 16) * (255 - alpha) + 127) / 255) << 16 |
-            (alpha + ((BYTE)(dst >> 24) * (255 - alpha) + 127) / 255) << 24);
+    DWORD rb = div255_pair( (src & 0x00ff00ff) * alpha + 0x007f007f );
+    DWORD ag = div255_pair( ((src >> 8) & 0x00ff00ff) * alpha + 0x007f007f );
+    return blend_argb( dst, rb | ag << 8 );
 }
 
 static inline DWORD blend_rgb( BYTE dst_r, BYTE dst_g, BYTE dst_b, DWORD src, BLENDFUNCTION blend )
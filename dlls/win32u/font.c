@@ -24,12 +24,15 @@
 #pragma makedep unix
 #endif
 
+#include "config.h"
+
 #include <limits.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include <pthread.h>
+#include <sys/stat.h>
 
 #include "ntstatus.h"
 #include "winerror.h"
@@ -1422,6 +1425,276 @@ static void remove_face_from_cache( struct gdi_font_face *face )
     NtClose( hkey_family );
 }
 
+/* cache of the faces found in the font files, to avoid parsing them again in every process;
+ * it is stored in a non-volatile key so that it also survives a wineserver restart */
+
+#define UNIX_FACE_CACHE_VERSION 2
+
+struct unix_face_cache_header
+{
+    DWORD                   version;
+    LCID                    lcid;
+};
+
+struct cached_unix_face
+{
+    DWORD                   len;        /* total length of the entry */
+    DWORD                   unix_name;  /* offset of the unix file name */
+    DWORD                   index;
+    DWORD                   flags;
+    ULONGLONG               mtime;      /* file modification time in nanoseconds */
+    ULONGLONG               file_size;
+    ULONGLONG               inode;
+    DWORD                   num_faces;
+    DWORD                   names_mask; /* which of the face names are present */
+    DWORD                   ntmflags;
+    DWORD                   weight;
+    DWORD                   version;
+    DWORD                   scalable;
+    struct bitmap_font_size size;
+    FONTSIGNATURE           fs;
+    WCHAR                   names[1];
+    /* WCHAR                second_name[], style_name[], full_name[]; */
+    /* char                 unix_name[]; */
+};
+
+struct unix_face_cache_entry
+{
+    struct wine_rb_entry     entry;
+    const char              *unix_name;
+    struct cached_unix_face *cached;
+};
+
+struct unix_face_cache_key
+{
+    const char *unix_name;
+    DWORD       index;
+    DWORD       flags;
+};
+
+static int unix_face_cache_compare( const void *key, const struct wine_rb_entry *entry )
+{
+    const struct unix_face_cache_key *face_key = key;
+    const struct unix_face_cache_entry *face = WINE_RB_ENTRY_VALUE( entry, const struct unix_face_cache_entry, entry );
+    int ret;
+
+    if ((ret = strcmp( face_key->unix_name, face->unix_name ))) return ret;
+    if (face_key->index != face->cached->index) return face_key->index > face->cached->index ? 1 : -1;
+    if (face_key->flags != face->cached->flags) return face_key->flags > face->cached->flags ? 1 : -1;
+    return 0;
+}
+
+static struct
+{
+    BOOL                enabled;    /* only used while loading the system and registry fonts */
+    BOOL                dirty;      /* some faces were not found in the cache */
+    HKEY                key;
+    struct wine_rb_tree tree;
+    void               *data;       /* previous cache contents */
+    char               *buffer;     /* updated cache contents */
+    SIZE_T              size;
+    SIZE_T              alloc;
+} unix_face_cache = { .tree = { unix_face_cache_compare } };
+
+static const WCHAR face_cache_keyW[] = {'F','a','c','e','C','a','c','h','e'};
+static const WCHAR unix_faces_valueW[] = {'U','n','i','x','F','a','c','e','s',0};
+
+static BOOL get_unix_file_stamp( const char *unix_name, ULONGLONG *mtime, ULONGLONG *file_size,
+                                 ULONGLONG *inode )
+{
+    struct stat st;
+
+    if (stat( unix_name, &st ) == -1) return FALSE;
+    *mtime = (ULONGLONG)st.st_mtime * 1000000000;
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+    *mtime += st.st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+    *mtime += st.st_mtimespec.tv_nsec;
+#endif
+    *file_size = st.st_size;
+    *inode = st.st_ino;
+    return TRUE;
+}
+
+static void append_unix_face_cache( const void *data, SIZE_T len )
+{
+    SIZE_T alloc;
+    char *buffer;
+
+    if (unix_face_cache.size + len > unix_face_cache.alloc)
+    {
+        alloc = max( max( unix_face_cache.alloc * 2, unix_face_cache.size + len ), 64 * 1024 );
+        if (!(buffer = realloc( unix_face_cache.buffer, alloc )))
+        {
+            unix_face_cache.enabled = FALSE;
+            return;
+        }
+        unix_face_cache.buffer = buffer;
+        unix_face_cache.alloc = alloc;
+    }
+    memcpy( unix_face_cache.buffer + unix_face_cache.size, data, len );
+    unix_face_cache.size += len;
+}
+
+static void load_unix_face_cache(void)
+{
+    struct unix_face_cache_header header = { UNIX_FACE_CACHE_VERSION };
+    unsigned int name_size = lstrlenW( unix_faces_valueW ) * sizeof(WCHAR);
+    UNICODE_STRING nameW = { name_size, name_size, (WCHAR *)unix_faces_valueW };
+    KEY_VALUE_PARTIAL_INFORMATION *info;
+    struct unix_face_cache_entry *entry;
+    struct cached_unix_face *cached;
+    struct unix_face_cache_key key;
+    ULONG size, pos, len;
+    char *data;
+    HKEY hkey;
+
+    NtQueryDefaultLocale( FALSE, &header.lcid );
+    unix_face_cache.enabled = TRUE;
+    append_unix_face_cache( &header, sizeof(header) );
+
+    if (!(hkey = reg_create_key( wine_fonts_key, face_cache_keyW, sizeof(face_cache_keyW), 0, NULL ))) return;
+    unix_face_cache.key = hkey;
+
+    /* the whole cache is read at once, entries are only validated when they are used */
+    if (NtQueryValueKey( hkey, &nameW, KeyValuePartialInformation, NULL, 0, &size ) != STATUS_BUFFER_TOO_SMALL ||
+        !(info = malloc( size )))
+        return;
+    if (NtQueryValueKey( hkey, &nameW, KeyValuePartialInformation, info, size, &size ) ||
+        info->Type != REG_BINARY || info->DataLength < sizeof(header) ||
+        memcmp( info->Data, &header, sizeof(header) ))
+    {
+        free( info );
+        return;
+    }
+
+    /* move the data to the start of the buffer to keep the entries aligned */
+    size = info->DataLength;
+    data = memmove( info, info->Data, size );
+    unix_face_cache.data = data;
+
+    for (pos = sizeof(header); size - pos >= sizeof(*cached); pos += len)
+    {
+        cached = (struct cached_unix_face *)(data + pos);
+        len = cached->len;
+        if (len < sizeof(*cached) || len > size - pos || len % sizeof(ULONGLONG)) break;
+        if (cached->unix_name < offsetof( struct cached_unix_face, names[4] ) || cached->unix_name >= len ||
+            cached->unix_name % sizeof(WCHAR) || ((WCHAR *)((char *)cached + cached->unix_name))[-1]) break;
+        if (!memchr( (char *)cached + cached->unix_name, 0, len - cached->unix_name )) break;
+
+        key.unix_name = (char *)cached + cached->unix_name;
+        key.index     = cached->index;
+        key.flags     = cached->flags;
+        if (wine_rb_get( &unix_face_cache.tree, &key )) continue;
+        if (!(entry = malloc( sizeof(*entry) ))) break;
+        entry->unix_name = key.unix_name;
+        entry->cached    = cached;
+        wine_rb_put( &unix_face_cache.tree, &key, &entry->entry );
+    }
+}
+
+static void free_unix_face_cache_entry( struct wine_rb_entry *entry, void *context )
+{
+    free( WINE_RB_ENTRY_VALUE( entry, struct unix_face_cache_entry, entry ) );
+}
+
+static void save_unix_face_cache(void)
+{
+    unix_face_cache.enabled = FALSE;
+
+    if (unix_face_cache.dirty && unix_face_cache.buffer && unix_face_cache.key)
+        set_reg_value( unix_face_cache.key, unix_faces_valueW, REG_BINARY,
+                       unix_face_cache.buffer, unix_face_cache.size );
+    if (unix_face_cache.key) NtClose( unix_face_cache.key );
+    unix_face_cache.key = NULL;
+
+    wine_rb_destroy( &unix_face_cache.tree, free_unix_face_cache_entry, NULL );
+    free( unix_face_cache.data );
+    free( unix_face_cache.buffer );
+    unix_face_cache.data = unix_face_cache.buffer = NULL;
+    unix_face_cache.size = unix_face_cache.alloc = 0;
+}
+
+int add_cached_unix_face( const char *unix_name, const WCHAR *file, UINT index, DWORD flags, DWORD *num_faces )
+{
+    struct unix_face_cache_key key = { unix_name, index, flags };
+    const WCHAR *names[4], *ptr;
+    struct cached_unix_face *cached;
+    struct wine_rb_entry *entry;
+    ULONGLONG mtime, file_size, inode;
+    int i;
+
+    if (!unix_face_cache.enabled) return -1;
+    if (!(entry = wine_rb_get( &unix_face_cache.tree, &key ))) return -1;
+    cached = WINE_RB_ENTRY_VALUE( entry, struct unix_face_cache_entry, entry )->cached;
+
+    if (!get_unix_file_stamp( unix_name, &mtime, &file_size, &inode ) ||
+        mtime != cached->mtime || file_size != cached->file_size || inode != cached->inode)
+        return -1;
+
+    for (i = 0, ptr = cached->names; i < ARRAY_SIZE(names); i++, ptr += lstrlenW( ptr ) + 1)
+        names[i] = (cached->names_mask & (1 << i)) ? ptr : NULL;
+
+    TRACE( "using cached face %s for %s index %u\n", debugstr_w(names[3]), debugstr_a(unix_name), index );
+
+    append_unix_face_cache( cached, cached->len );
+    if (num_faces) *num_faces = cached->num_faces;
+    if (!names[0]) return 0;  /* the face was rejected */
+    return add_gdi_face( names[0], names[1], names[2], names[3], file, NULL, 0, index, cached->fs,
+                         cached->ntmflags, cached->weight, cached->version, flags,
+                         cached->scalable ? NULL : &cached->size );
+}
+
+void cache_unix_face( const char *unix_name, UINT index, DWORD flags, DWORD num_faces,
+                      const WCHAR *family_name, const WCHAR *second_name, const WCHAR *style,
+                      const WCHAR *fullname, FONTSIGNATURE fs, DWORD ntmflags, DWORD weight,
+                      DWORD version, const struct bitmap_font_size *size )
+{
+    const WCHAR *names[4] = { family_name, second_name, style, fullname };
+    struct cached_unix_face *cached;
+    ULONGLONG mtime, file_size, inode;
+    DWORD len, name_len;
+    WCHAR *ptr;
+    int i;
+
+    if (!unix_face_cache.enabled) return;
+    if (!get_unix_file_stamp( unix_name, &mtime, &file_size, &inode )) return;
+
+    len = offsetof( struct cached_unix_face, names );
+    for (i = 0; i < ARRAY_SIZE(names); i++) len += (names[i] ? lstrlenW( names[i] ) + 1 : 1) * sizeof(WCHAR);
+    name_len = strlen( unix_name ) + 1;
+    len = (len + name_len + sizeof(ULONGLONG) - 1) & ~(sizeof(ULONGLONG) - 1);
+    if (!(cached = calloc( 1, len ))) return;
+
+    cached->len       = len;
+    cached->index     = index;
+    cached->flags     = flags;
+    cached->mtime     = mtime;
+    cached->file_size = file_size;
+    cached->inode     = inode;
+    cached->num_faces = num_faces;
+    cached->ntmflags  = ntmflags;
+    cached->weight    = weight;
+    cached->version   = version;
+    cached->fs        = fs;
+    if (size) cached->size = *size;
+    else cached->scalable = TRUE;
+
+    for (i = 0, ptr = cached->names; i < ARRAY_SIZE(names); i++, ptr++)
+    {
+        if (!names[i]) continue;
+        cached->names_mask |= 1 << i;
+        lstrcpyW( ptr, names[i] );
+        ptr += lstrlenW( ptr );
+    }
+    cached->unix_name = (char *)ptr - (char *)cached;
+    memcpy( ptr, unix_name, name_len );
+
+    append_unix_face_cache( cached, len );
+    unix_face_cache.dirty = TRUE;
+    free( cached );
+}
+
 /* font links */
 
 struct gdi_font_link
@@ -6738,6 +7011,7 @@ UINT font_init(void)
     if (!(font_funcs = init_freetype_lib()))
         return dpi;
 
+    load_unix_face_cache();
     load_system_bitmap_fonts();
     load_file_system_fonts();
     font_funcs->load_fonts();
@@ -6747,7 +7021,11 @@ UINT font_init(void)
     name.Buffer = wine_font_mutexW;
     name.Length = name.MaximumLength = sizeof(wine_font_mutexW);
 
-    if (NtCreateMutant( &mutex, MUTEX_ALL_ACCESS, &attr, FALSE ) < 0) return dpi;
+    if (NtCreateMutant( &mutex, MUTEX_ALL_ACCESS, &attr, FALSE ) < 0)
+    {
+        save_unix_face_cache();
+        return dpi;
+    }
     NtWaitForSingleObject( mutex, FALSE, NULL );
 
     wine_fonts_cache_key = reg_create_key( wine_fonts_key, cacheW, sizeof(cacheW),
@@ -6767,6 +7045,8 @@ UINT font_init(void)
         load_font_list_from_cache();
     }
 
+    save_unix_face_cache();
+
     reorder_font_list();
     load_gdi_font_subst();
     load_gdi_font_replacements();
@@ -1024,21 +1024,33 @@ static int add_unix_face( const char *unix_name, const WCHAR *file, void *data_p
 
     if (num_faces) *num_faces = 0;
 
+    if (!HIWORD( flags )) flags |= ADDFONT_AA_FLAGS( default_aa_flags );
+
+    if (unix_name && (ret = add_cached_unix_face( unix_name, file, face_index, flags, num_faces )) >= 0)
+        return ret;
+
     if (!(unix_face = unix_face_create( unix_name, data_ptr, data_size, face_index, flags )))
         return 0;
 
     if (unix_face->family_name[0] == '.') /* Ignore fonts with names beginning with a dot */
     {
         TRACE("Ignoring %s since its family name begins with a dot\n", debugstr_a(unix_name));
+        /* remember the rejection to avoid parsing the file again */
+        if (unix_name)
+            cache_unix_face( unix_name, face_index, flags, 0, NULL, NULL, NULL, NULL, unix_face->fs,
+                             0, 0, 0, NULL );
         unix_face_destroy( unix_face );
         return 0;
     }
 
-    if (!HIWORD( flags )) flags |= ADDFONT_AA_FLAGS( default_aa_flags );
-
     ret = add_gdi_face( unix_face->family_name, unix_face->second_name, unix_face->style_name, unix_face->full_name,
                         file, data_ptr, data_size, face_index, unix_face->fs, unix_face->ntm_flags, unix_face->weight,
                         unix_face->font_version, flags, unix_face->scalable ? NULL : &unix_face->size );
+    if (unix_name)
+        cache_unix_face( unix_name, face_index, flags, unix_face->num_faces, unix_face->family_name,
+                         unix_face->second_name, unix_face->style_name, unix_face->full_name, unix_face->fs,
+                         unix_face->ntm_flags, unix_face->weight, unix_face->font_version,
+                         unix_face->scalable ? NULL : &unix_face->size );
 
     TRACE("fsCsb = %08x %08x/%08x %08x %08x %08x\n",
           unix_face->fs.fsCsb[0], unix_face->fs.fsCsb[1],
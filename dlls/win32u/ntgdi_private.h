@@ -345,6 +345,12 @@ extern int add_gdi_face( const WCHAR *family_name, const WCHAR *second_name,
                          void *data_ptr, SIZE_T data_size, UINT index, FONTSIGNATURE fs,
                          DWORD ntmflags, DWORD weight, DWORD version, DWORD flags,
                          const struct bitmap_font_size *size );
+extern int add_cached_unix_face( const char *unix_name, const WCHAR *file, UINT index, DWORD flags,
+                                 DWORD *num_faces );
+extern void cache_unix_face( const char *unix_name, UINT index, DWORD flags, DWORD num_faces,
+                             const WCHAR *family_name, const WCHAR *second_name, const WCHAR *style,
+                             const WCHAR *fullname, FONTSIGNATURE fs, DWORD ntmflags, DWORD weight,
+                             DWORD version, const struct bitmap_font_size *size );
 extern UINT font_init(void);
 extern const struct font_backend_funcs *init_freetype_lib(void);
 
@@ -1172,6 +1172,25 @@ UINT get_window_fnid( HWND hwnd )
     return status ? 0 : fnid;
 }
 
+/* read the window style or extended style from the session shared memory */
+static DWORD get_shared_window_style( HWND hwnd, INT offset )
+{
+    struct object_lock lock = OBJECT_LOCK_INIT;
+    const window_shm_t *window_shm = NULL;
+    UINT status;
+    DWORD style = 0;
+
+    while ((status = get_shared_window( hwnd, &lock, &window_shm )) == STATUS_PENDING)
+        style = offset == GWL_STYLE ? window_shm->style : window_shm->ex_style;
+    if (status)
+    {
+        RtlSetLastWin32Error( ERROR_INVALID_WINDOW_HANDLE );
+        return 0;
+    }
+
+    return style;
+}
+
 static LONG_PTR get_window_long_size( HWND hwnd, INT offset, UINT size, BOOL ansi, BOOL internal )
 {
     LONG_PTR retval = 0;
@@ -1220,6 +1239,7 @@ static LONG_PTR get_window_long_size( HWND hwnd, INT offset, UINT size, BOOL ans
             RtlSetLastWin32Error( ERROR_ACCESS_DENIED );
             return 0;
         }
+        if (offset == GWL_STYLE || offset == GWL_EXSTYLE) return get_shared_window_style( hwnd, offset );
         SERVER_START_REQ( get_window_info )
         {
             req->handle = wine_server_user_handle( hwnd );
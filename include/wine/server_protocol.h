@@ -1053,6 +1053,8 @@ typedef volatile struct
     unsigned int         dpi_context;
     unsigned int         fnid;
     data_size_t          private_size;
+    unsigned int         style;
+    unsigned int         ex_style;
 } window_shm_t;
 
 typedef volatile union
@@ -7130,6 +7132,6 @@ union generic_reply
     struct d3dkmt_mutex_release_reply d3dkmt_mutex_release_reply;
 };
 
-#define SERVER_PROTOCOL_VERSION 943
+#define SERVER_PROTOCOL_VERSION 944
 
 #endif /* __WINE_WINE_SERVER_PROTOCOL_H */
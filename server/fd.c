@@ -155,6 +155,7 @@ struct fd
     unsigned int         cacheable :1;/* can the fd be cached on the client side? */
     unsigned int         fs_locks :1; /* can we use filesystem locks for this fd? */
     int                  poll_index;  /* index of fd in poll array */
+    int                  epoll_events; /* events currently registered with epoll */
     struct async_queue   read_q;      /* async readers of this fd */
     struct async_queue   write_q;     /* async writers of this fd */
     struct async_queue   wait_q;      /* other async waiters of this fd */
@@ -539,28 +540,10 @@ static inline void init_epoll(void)
     epoll_fd = epoll_create( 128 );
 }
 
-/* set the events that epoll waits for on this fd; helper for set_fd_events */
-static inline void set_fd_epoll_events( struct fd *fd, int user, int events )
+/* update the epoll set for this fd */
+static void epoll_ctl_user( struct fd *fd, int user, int ctl, int events )
 {
     struct epoll_event ev;
-    int ctl;
-
-    if (epoll_fd == -1) return;
-
-    if (events == -1)  /* stop waiting on this fd completely */
-    {
-        if (pollfd[user].fd == -1) return;  /* already removed */
-        ctl = EPOLL_CTL_DEL;
-    }
-    else if (pollfd[user].fd == -1)
-    {
-        ctl = EPOLL_CTL_ADD;
-    }
-    else
-    {
-        if (pollfd[user].events == events) return;  /* nothing to do */
-        ctl = EPOLL_CTL_MOD;
-    }
 
     ev.events = events;
     memset(&ev.data, 0, sizeof(ev.data));
@@ -574,6 +557,33 @@ static inline void set_fd_epoll_events( struct fd *fd, int user, int events )
             epoll_fd = -1;
         }
         else perror( "epoll_ctl" );  /* should not happen */
+        /* only trust a mask that the kernel actually accepted */
+        if (ctl != EPOLL_CTL_MOD) fd->epoll_events = 0;
+    }
+    else fd->epoll_events = events;
+}
+
+/* set the events that epoll waits for on this fd; helper for set_fd_events */
+static inline void set_fd_epoll_events( struct fd *fd, int user, int events )
+{
+    if (epoll_fd == -1) return;
+
+    if (events == -1)  /* stop waiting on this fd completely */
+    {
+        if (pollfd[user].fd == -1) return;  /* already removed */
+        epoll_ctl_user( fd, user, EPOLL_CTL_DEL, 0 );
+    }
+    else if (pollfd[user].fd == -1)
+    {
+        epoll_ctl_user( fd, user, EPOLL_CTL_ADD, events );
+    }
+    else
+    {
+        /* events that are no longer wanted are filtered out by the main loop, and only
+         * removed from the epoll set once they actually fire; this avoids a pair of
+         * epoll_ctl calls every time a mask is temporarily narrowed and restored */
+        if (!(events & ~fd->epoll_events)) return;
+        epoll_ctl_user( fd, user, EPOLL_CTL_MOD, events );
     }
 }
 
@@ -628,7 +638,12 @@ static inline void main_loop_epoll(void)
         for (i = 0; i < ret; i++)
         {
             int user = events[i].data.u32;
-            pollfd[user].revents = events[i].events;
+            int wanted = pollfd[user].events | POLLERR | POLLHUP;
+
+            pollfd[user].revents = events[i].events & wanted;
+            /* stop listening for events that have been lazily left in the epoll set */
+            if ((events[i].events & ~wanted) && pollfd[user].fd != -1)
+                epoll_ctl_user( poll_users[user], user, EPOLL_CTL_MOD, pollfd[user].events );
         }
 
         /* read events from the pollfd array, as set_fd_events may modify them */
@@ -1736,6 +1751,7 @@ static struct fd *alloc_fd_object(void)
     fd->cacheable  = 0;
     fd->fs_locks   = 1;
     fd->poll_index = -1;
+    fd->epoll_events = 0;
     fd->completion = NULL;
     fd->comp_flags = 0;
     init_async_queue( &fd->read_q );
@@ -1778,6 +1794,7 @@ struct fd *alloc_pseudo_fd( const struct fd_ops *fd_user_ops, struct object *use
     fd->cacheable  = 0;
     fd->fs_locks   = 0;
     fd->poll_index = -1;
+    fd->epoll_events = 0;
     fd->completion = NULL;
     fd->comp_flags = 0;
     fd->no_fd_status = STATUS_BAD_DEVICE_TYPE;
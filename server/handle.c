@@ -51,6 +51,7 @@ struct handle_table
     int                  count;       /* number of allocated entries */
     int                  last;        /* last used entry */
     int                  free;        /* first entry that may be free */
+    int                  used;        /* number of entries in use */
     struct handle_entry *entries;     /* handle entries */
 };
 
@@ -209,6 +210,7 @@ struct handle_table *alloc_handle_table( struct process *process, int count )
     table->count   = count;
     table->last    = -1;
     table->free    = 0;
+    table->used    = 0;
     if ((table->entries = mem_alloc( count * sizeof(*table->entries) ))) return table;
     release_object( table );
     return NULL;
@@ -234,18 +236,24 @@ static int grow_handle_table( struct handle_table *table )
 /* allocate the first free entry in the handle table */
 static obj_handle_t alloc_entry( struct handle_table *table, void *obj, unsigned int access )
 {
-    struct handle_entry *entry = table->entries + table->free;
-    int i;
+    struct handle_entry *entry;
+    int i = table->last + 1;
 
-    for (i = table->free; i <= table->last; i++, entry++) if (!entry->ptr) goto found;
+    /* only scan for a free entry if some entries before the last one are unused */
+    if (table->used <= table->last)
+    {
+        for (i = table->free, entry = table->entries + i; i <= table->last; i++, entry++)
+            if (!entry->ptr) goto found;
+    }
     if (i >= table->count)
     {
         if (!grow_handle_table( table )) return 0;
-        entry = table->entries + i;  /* the entries may have moved */
     }
     table->last = i;
  found:
+    entry = table->entries + i;  /* the entries may have moved */
     table->free = i + 1;
+    table->used++;
     entry->ptr    = grab_object_for_handle( obj );
     entry->access = access;
     return index_to_handle(i);
@@ -371,6 +379,7 @@ static void inherit_handle( struct process *parent, const obj_handle_t handle, s
     grab_object_for_handle( src->ptr );
     dst[index] = *src;
     table->last = max( table->last, index );
+    table->used++;
 }
 
 /* copy the handle table of the parent process */
@@ -412,7 +421,11 @@ struct handle_table *copy_handle_table( struct process *process, struct process
             for (i = 0; i <= table->last; i++, ptr++)
             {
                 if (!ptr->ptr) continue;
-                if (ptr->access & RESERVED_INHERIT) grab_object_for_handle( ptr->ptr );
+                if (ptr->access & RESERVED_INHERIT)
+                {
+                    grab_object_for_handle( ptr->ptr );
+                    table->used++;
+                }
                 else ptr->ptr = NULL; /* don't inherit this entry */
             }
         }
@@ -437,6 +450,7 @@ unsigned int close_handle( struct process *process, obj_handle_t handle )
 
     table = handle_is_global(handle) ? global_table : process->handles;
     table->entries[index].ptr = NULL;
+    table->used--;
     if (index < table->free) table->free = index;
     if (index == table->last) shrink_handle_table( table );
     release_object_from_handle( obj );
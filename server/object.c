@@ -44,10 +44,14 @@
 #include "request.h"
 
 
+#define MAX_HASH_CHAIN     8     /* grow the hash table when a hash chain gets longer than this */
+#define MAX_NAMESPACE_HASH 4093  /* maximum size of a namespace hash table */
+
 struct namespace
 {
     unsigned int        hash_size;       /* size of hash table */
-    struct list         names[1];        /* array of hash entry lists */
+    struct list        *names;           /* array of hash entry lists */
+    struct list         order;           /* all the names in insertion order, for enumeration */
 };
 
 
@@ -238,11 +242,41 @@ void *memdup( const void *data, size_t len )
 
 /*****************************************************************/
 
+/* grow the hash table of a namespace that has too many entries */
+static void grow_namespace( struct namespace *namespace )
+{
+    unsigned int i, new_size = min( namespace->hash_size * 4 + 1, MAX_NAMESPACE_HASH );
+    struct object_name *ptr, *next;
+    struct list *names;
+
+    if (!(names = malloc( new_size * sizeof(*names) ))) return;  /* keep using the old one */
+    for (i = 0; i < new_size; i++) list_init( &names[i] );
+
+    /* entries of a given old chain keep their relative order, so lookups still find the most recent one */
+    for (i = 0; i < namespace->hash_size; i++)
+    {
+        LIST_FOR_EACH_ENTRY_SAFE( ptr, next, &namespace->names[i], struct object_name, entry )
+        {
+            list_remove( &ptr->entry );
+            list_add_tail( &names[hash_strW( ptr->name, ptr->len, new_size )], &ptr->entry );
+        }
+    }
+    free( namespace->names );
+    namespace->names = names;
+    namespace->hash_size = new_size;
+}
+
 void namespace_add( struct namespace *namespace, struct object_name *ptr )
 {
     unsigned int hash = hash_strW( ptr->name, ptr->len, namespace->hash_size );
 
+    if (namespace->hash_size < MAX_NAMESPACE_HASH && list_count( &namespace->names[hash] ) >= MAX_HASH_CHAIN)
+    {
+        grow_namespace( namespace );
+        hash = hash_strW( ptr->name, ptr->len, namespace->hash_size );
+    }
     list_add_head( &namespace->names[hash], &ptr->entry );
+    list_add_tail( &namespace->order, &ptr->order_entry );
 }
 
 /* allocate a name for an object */
@@ -588,16 +622,13 @@ struct object *find_object( const struct namespace *namespace, const struct unic
 /* find an object by its index; the refcount is incremented */
 struct object *find_object_index( const struct namespace *namespace, unsigned int index )
 {
-    unsigned int i;
+    const struct object_name *ptr;
 
     /* FIXME: not efficient at all */
-    for (i = 0; i < namespace->hash_size; i++)
+    /* the insertion order doesn't depend on the hash size, so growing the table doesn't affect it */
+    LIST_FOR_EACH_ENTRY( ptr, &namespace->order, const struct object_name, order_entry )
     {
-        const struct object_name *ptr;
-        LIST_FOR_EACH_ENTRY( ptr, &namespace->names[i], const struct object_name, entry )
-        {
-            if (!index--) return grab_object( ptr->obj );
-        }
+        if (!index--) return grab_object( ptr->obj );
     }
     return NULL;
 }
@@ -608,15 +639,26 @@ struct namespace *create_namespace( unsigned int hash_size )
     struct namespace *namespace;
     unsigned int i;
 
-    namespace = mem_alloc( sizeof(*namespace) + (hash_size - 1) * sizeof(namespace->names[0]) );
-    if (namespace)
+    if (!(namespace = mem_alloc( sizeof(*namespace) ))) return NULL;
+    if (!(namespace->names = mem_alloc( hash_size * sizeof(namespace->names[0]) )))
     {
-        namespace->hash_size      = hash_size;
-        for (i = 0; i < hash_size; i++) list_init( &namespace->names[i] );
+        free( namespace );
+        return NULL;
     }
+    namespace->hash_size = hash_size;
+    for (i = 0; i < hash_size; i++) list_init( &namespace->names[i] );
+    list_init( &namespace->order );
     return namespace;
 }
 
+/* free a namespace */
+void free_namespace( struct namespace *namespace )
+{
+    if (!namespace) return;
+    free( namespace->names );
+    free( namespace );
+}
+
 /* functions for unimplemented/default object operations */
 
 int no_add_queue( struct object *obj, struct wait_queue_entry *entry )
@@ -820,6 +862,7 @@ int no_link_name( struct object *obj, struct object_name *name, struct object *p
 void default_unlink_name( struct object *obj, struct object_name *name )
 {
     list_remove( &name->entry );
+    list_remove( &name->order_entry );
 }
 
 struct object *no_open_file( struct object *obj, unsigned int access, unsigned int sharing,
@@ -698,6 +698,8 @@ struct process *create_process( int fd, struct process *parent, unsigned int fla
     process->desktop         = 0;
     process->token           = NULL;
     process->trace_data      = 0;
+    process->req_count       = 0;
+    process->req_time        = 0;
     process->rawinput_devices = NULL;
     process->rawinput_device_count = 0;
     process->rawinput_mouse  = NULL;
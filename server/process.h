@@ -83,6 +83,8 @@ struct process
     client_ptr_t         peb;             /* PEB address in client address space */
     struct dir_cache    *dir_cache;       /* map of client-side directory cache */
     unsigned int         trace_data;      /* opaque data used by the process tracing mechanism */
+    unsigned int         req_count;       /* number of requests handled for this process */
+    timeout_t            req_time;        /* total time spent handling its requests */
     struct rawinput_device *rawinput_devices;     /* list of registered rawinput devices */
     unsigned int         rawinput_device_count;   /* number of registered rawinput devices */
     const struct rawinput_device *rawinput_mouse; /* rawinput mouse device, if any */
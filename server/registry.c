@@ -84,8 +84,12 @@ struct key
     WCHAR            *class;       /* key class */
     data_size_t       classlen;    /* length of class name */
     int               last_subkey; /* last in use subkey */
+    int               last_sorted; /* last subkey in sorted order, the following ones are unsorted */
     int               nb_subkeys;  /* count of allocated subkeys */
     struct key      **subkeys;     /* subkeys array */
+    struct list      *subkey_hash; /* hash index of subkeys, for keys with many subkeys */
+    unsigned int      hash_size;   /* size of the subkey hash index */
+    struct list       hash_entry;  /* entry in parent's subkey hash index */
     struct key       *wow6432node; /* Wow6432Node subkey */
     int               last_value;  /* last in use value */
     int               nb_values;   /* count of allocated values in array */
@@ -116,11 +120,14 @@ struct key_value
 };
 
 #define MIN_SUBKEYS  8   /* min. number of allocated subkeys per key */
+#define MIN_SUBKEY_HASH 64  /* min. number of subkeys to build a hash index */
 #define MIN_VALUES   8   /* min. number of allocated values per key */
 
 #define MAX_NAME_LEN  256    /* max. length of a key name */
 #define MAX_VALUE_LEN 16383  /* max. length of a value name */
 
+#define SAVE_BUFFER_SIZE (64 * 1024)  /* size of the stdio buffer used when saving */
+
 /* the root of the registry tree */
 static struct key *root_key;
 
@@ -161,6 +168,12 @@ struct file_load_info
     int         line;     /* current input line */
     WCHAR      *tmp;      /* temp buffer to use while parsing input */
     size_t      tmplen;   /* length of temp buffer */
+    WCHAR      *path;     /* path of the last loaded key */
+    data_size_t pathlen;  /* length of the last loaded key path */
+    data_size_t pathsize; /* allocated size of the path buffer */
+    struct key **keys;    /* keys for each element of the last loaded key path */
+    int         depth;    /* number of elements in the last loaded key path */
+    int         nb_keys;  /* allocated size of the keys array */
 };
 
 
@@ -238,7 +251,9 @@ static void dump_path( const struct key *key, const struct key *base, FILE *f )
 /* dump a value to a text file */
 static void dump_value( const struct key_value *value, FILE *f )
 {
+    static const char hex[16] = "0123456789abcdef";
     unsigned int i, dw;
+    char buffer[256], *pos = buffer;
     int count;
 
     if (value->namelen)
@@ -275,26 +290,52 @@ static void dump_value( const struct key_value *value, FILE *f )
     else count += fprintf( f, "hex(%x):", value->type );
     for (i = 0; i < value->len; i++)
     {
-        count += fprintf( f, "%02x", *((unsigned char *)value->data + i) );
+        unsigned char ch = *((unsigned char *)value->data + i);
+
+        if (pos > buffer + sizeof(buffer) - 8)
+        {
+            fwrite( buffer, pos - buffer, 1, f );
+            pos = buffer;
+        }
+        *pos++ = hex[ch >> 4];
+        *pos++ = hex[ch & 0x0f];
+        count += 2;
         if (i < value->len-1)
         {
-            fputc( ',', f );
+            *pos++ = ',';
             if (++count > 76)
             {
-                fprintf( f, "\\\n  " );
+                memcpy( pos, "\\\n  ", 4 );
+                pos += 4;
                 count = 2;
             }
         }
     }
-    fputc( '\n', f );
+    *pos++ = '\n';
+    fwrite( buffer, pos - buffer, 1, f );
 }
 
-/* find the named child of a given key and return its index */
+/* find the named child of a given key and return its index; index can be NULL if not needed */
+/* the subkeys must be sorted when the index is requested */
 static struct key *find_subkey( const struct key *key, const struct unicode_str *name, int *index )
 {
     int i, min, max, res;
     data_size_t len;
 
+    if (!index && key->subkey_hash)
+    {
+        struct key *subkey;
+
+        LIST_FOR_EACH_ENTRY( subkey, &key->subkey_hash[hash_strW( name->str, name->len, key->hash_size )],
+                             struct key, hash_entry )
+        {
+            if (subkey->obj.name->len != name->len) continue;
+            if (!memicmp_strW( subkey->obj.name->name, name->str, name->len )) return subkey;
+        }
+        return NULL;
+    }
+
+    assert( key->last_sorted == key->last_subkey );
     min = 0;
     max = key->last_subkey;
     while (min <= max)
@@ -305,16 +346,80 @@ static struct key *find_subkey( const struct key *key, const struct unicode_str
         if (!res) res = key->subkeys[i]->obj.name->len - name->len;
         if (!res)
         {
-            *index = i;
+            if (index) *index = i;
             return key->subkeys[i];
         }
         if (res > 0) max = i - 1;
         else min = i + 1;
     }
-    *index = min;  /* this is where we should insert it */
+    if (index) *index = min;  /* this is where we should insert it */
     return NULL;
 }
 
+/* add a subkey to the hash index of its parent */
+static void hash_subkey( struct key *parent, struct key *key )
+{
+    unsigned int hash = hash_strW( key->obj.name->name, key->obj.name->len, parent->hash_size );
+    list_add_head( &parent->subkey_hash[hash], &key->hash_entry );
+}
+
+/* build the hash index of subkeys once a key has enough of them */
+static void build_subkey_hash( struct key *key )
+{
+    unsigned int i, size = key->last_subkey + 1;
+    struct list *hash;
+
+    if (size < MIN_SUBKEY_HASH || size <= 2 * key->hash_size) return;
+    if (!(hash = malloc( size * sizeof(*hash) ))) return;  /* keep using the old one */
+    for (i = 0; i < size; i++) list_init( &hash[i] );
+    free( key->subkey_hash );
+    key->subkey_hash = hash;
+    key->hash_size = size;
+    for (i = 0; i < size; i++) hash_subkey( key, key->subkeys[i] );
+}
+
+/* compare the names of two subkeys, using the same order as find_subkey */
+static int compare_subkeys( const void *p1, const void *p2 )
+{
+    const struct object_name *name1 = (*(struct key * const *)p1)->obj.name;
+    const struct object_name *name2 = (*(struct key * const *)p2)->obj.name;
+    int res = memicmp_strW( name1->name, name2->name, min( name1->len, name2->len ) );
+
+    if (!res) res = (int)name1->len - (int)name2->len;
+    return res;
+}
+
+/* merge the subkeys appended since the last sort into the sorted part of the array */
+static void sort_subkeys( struct key *key )
+{
+    int i, j, k, count = key->last_subkey - key->last_sorted;
+    struct key **tail;
+
+    if (!count) return;
+
+    qsort( key->subkeys + key->last_sorted + 1, count, sizeof(*key->subkeys), compare_subkeys );
+    if (key->last_sorted >= 0)
+    {
+        if ((tail = malloc( count * sizeof(*tail) )))
+        {
+            memcpy( tail, key->subkeys + key->last_sorted + 1, count * sizeof(*tail) );
+            i = key->last_sorted;
+            j = count - 1;
+            k = key->last_subkey;
+            while (j >= 0)
+            {
+                if (i >= 0 && compare_subkeys( &key->subkeys[i], &tail[j] ) > 0)
+                    key->subkeys[k--] = key->subkeys[i--];
+                else
+                    key->subkeys[k--] = tail[j--];
+            }
+            free( tail );
+        }
+        else qsort( key->subkeys, key->last_subkey + 1, sizeof(*key->subkeys), compare_subkeys );
+    }
+    key->last_sorted = key->last_subkey;
+}
+
 /* try to grow the array of subkeys; return 1 if OK, 0 on error */
 static int grow_subkeys( struct key *key )
 {
@@ -341,7 +446,7 @@ static int grow_subkeys( struct key *key )
 }
 
 /* save a registry and all its subkeys to a text file */
-static void save_subkeys( const struct key *key, const struct key *base, FILE *f )
+static void save_subkeys( struct key *key, const struct key *base, FILE *f )
 {
     int i;
 
@@ -363,6 +468,7 @@ static void save_subkeys( const struct key *key, const struct key *base, FILE *f
         if (key->flags & KEY_SYMLINK) fputs( "#link\n", f );
         for (i = 0; i <= key->last_value; i++) dump_value( &key->values[i], f );
     }
+    sort_subkeys( key );
     for (i = 0; i <= key->last_subkey; i++) save_subkeys( key->subkeys[i], base, f );
 }
 
@@ -547,13 +653,13 @@ static struct object *key_lookup_name( struct object *obj, struct unicode_str *n
     for (next = tmp.len; next < name->len; next += sizeof(WCHAR))
         if (name->str[next / sizeof(WCHAR)] != '\\') break;
 
-    if (!(found = find_subkey( key, &tmp, &index )))
+    if (!(found = find_subkey( key, &tmp, NULL )))
     {
         if ((key->flags & KEY_WOWSHARE) && (attr & OBJ_KEY_WOW64))
         {
             /* try in the 64-bit parent */
             key = get_parent( key );
-            if (!(found = find_subkey( key, &tmp, &index ))) return grab_object( key );
+            if (!(found = find_subkey( key, &tmp, NULL ))) return grab_object( key );
         }
     }
 
@@ -586,7 +692,7 @@ static int key_link_name( struct object *obj, struct object_name *name, struct o
     struct key *key = (struct key *)obj;
     struct key *parent_key = (struct key *)parent;
     struct unicode_str tmp;
-    int i, index;
+    int index;
 
     if (parent->ops != &key_ops)
     {
@@ -601,13 +707,24 @@ static int key_link_name( struct object *obj, struct object_name *name, struct o
         /* need to grow the array */
         if (!grow_subkeys( parent_key )) return 0;
     }
-    tmp.str = name->name;
-    tmp.len = name->len;
-    find_subkey( parent_key, &tmp, &index );
+    if (parent_key->subkey_hash)
+    {
+        /* keys with a hash index are only sorted when the order is needed */
+        parent_key->subkeys[++parent_key->last_subkey] = (struct key *)grab_object( key );
+        hash_subkey( parent_key, key );
+    }
+    else
+    {
+        tmp.str = name->name;
+        tmp.len = name->len;
+        find_subkey( parent_key, &tmp, &index );
 
-    for (i = ++parent_key->last_subkey; i > index; i--)
-        parent_key->subkeys[i] = parent_key->subkeys[i - 1];
-    parent_key->subkeys[index] = (struct key *)grab_object( key );
+        memmove( parent_key->subkeys + index + 1, parent_key->subkeys + index,
+                 (++parent_key->last_subkey - index) * sizeof(*parent_key->subkeys) );
+        parent_key->subkeys[index] = (struct key *)grab_object( key );
+        parent_key->last_sorted = parent_key->last_subkey;
+    }
+    build_subkey_hash( parent_key );
     if (is_wow6432node( name->name, name->len ) &&
         !is_wow6432node( parent_key->obj.name->name, parent_key->obj.name->len ))
         parent_key->wow6432node = key;
@@ -631,8 +748,11 @@ static void key_unlink_name( struct object *obj, struct object_name *name )
 
     for (i = 0; i <= parent->last_subkey; i++) if (parent->subkeys[i] == key) break;
     assert( i <= parent->last_subkey );
-    for ( ; i < parent->last_subkey; i++) parent->subkeys[i] = parent->subkeys[i + 1];
+    memmove( parent->subkeys + i, parent->subkeys + i + 1,
+             (parent->last_subkey - i) * sizeof(*parent->subkeys) );
     parent->last_subkey--;
+    if (i <= parent->last_sorted) parent->last_sorted--;
+    if (parent->subkey_hash) list_remove( &key->hash_entry );
     name->parent = NULL;
     if (parent->wow6432node == key) parent->wow6432node = NULL;
     release_object( key );
@@ -679,6 +799,7 @@ static void key_destroy( struct object *obj )
         release_object( key->subkeys[i] );
     }
     free( key->subkeys );
+    free( key->subkey_hash );
     /* unconditionally notify everything waiting on this key */
     while ((ptr = list_head( &key->notify_list )))
     {
@@ -705,8 +826,11 @@ static struct key *create_key_object( struct object *parent, const struct unicod
             key->classlen    = 0;
             key->flags       = 0;
             key->last_subkey = -1;
+            key->last_sorted = -1;
             key->nb_subkeys  = 0;
             key->subkeys     = NULL;
+            key->subkey_hash = NULL;
+            key->hash_size   = 0;
             key->wow6432node = NULL;
             key->nb_values   = 0;
             key->last_value  = -1;
@@ -792,7 +916,6 @@ static struct key *get_wow6432node( struct key *key )
 {
     struct key *parent, *ret;
     struct unicode_str name;
-    int index;
 
     if (!key)
         return NULL;
@@ -809,7 +932,7 @@ static struct key *get_wow6432node( struct key *key )
 
     name.str = key->obj.name->name;
     name.len = key->obj.name->len;
-    return find_subkey( ret, &name, &index );
+    return find_subkey( ret, &name, NULL );
 }
 
 /* open a subkey */
@@ -927,6 +1050,7 @@ static void enum_key( struct key *key, int index, int info_class, struct enum_ke
             set_error( STATUS_NO_MORE_ENTRIES );
             return;
         }
+        sort_subkeys( key );
         key = key->subkeys[index];
     }
 
@@ -1018,6 +1142,7 @@ static void rename_key( struct key *key, const struct unicode_str *new_name )
     }
 
     /* check for existing subkey with the same name */
+    if (parent) sort_subkeys( parent );
     if (!parent || find_subkey( parent, new_name, &index ))
     {
         set_error( STATUS_CANNOT_DELETE );
@@ -1054,6 +1179,11 @@ static void rename_key( struct key *key, const struct unicode_str *new_name )
 
     free( key->obj.name );
     key->obj.name = new_name_ptr;
+    if (parent->subkey_hash)
+    {
+        list_remove( &key->hash_entry );
+        hash_subkey( parent, key );
+    }
 
     if (debug_level > 1) dump_operation( key, NULL, "Rename" );
     touch_key( key, REG_NOTIFY_CHANGE_NAME );
@@ -1151,7 +1281,6 @@ static struct key_value *insert_value( struct key *key, const struct unicode_str
 {
     struct key_value *value;
     WCHAR *new_name = NULL;
-    int i;
 
     if (name->len > MAX_VALUE_LEN * sizeof(WCHAR))
     {
@@ -1163,7 +1292,8 @@ static struct key_value *insert_value( struct key *key, const struct unicode_str
         if (!grow_values( key )) return NULL;
     }
     if (name->len && !(new_name = memdup( name->str, name->len ))) return NULL;
-    for (i = ++key->last_value; i > index; i--) key->values[i] = key->values[i - 1];
+    memmove( key->values + index + 1, key->values + index,
+             (++key->last_value - index) * sizeof(*key->values) );
     value = &key->values[index];
     value->name    = new_name;
     value->namelen = name->len;
@@ -1313,7 +1443,7 @@ static void enum_value( struct key *key, int i, int info_class, struct enum_key_
 static void delete_value( struct key *key, const struct unicode_str *name )
 {
     struct key_value *value;
-    int i, index, nb_values;
+    int index, nb_values;
 
     if (key->flags & KEY_PREDEF)
     {
@@ -1329,7 +1459,8 @@ static void delete_value( struct key *key, const struct unicode_str *name )
     if (debug_level > 1) dump_operation( key, value, "Delete" );
     free( value->name );
     free( value->data );
-    for (i = index; i < key->last_value; i++) key->values[i] = key->values[i + 1];
+    memmove( key->values + index, key->values + index + 1,
+             (key->last_value - index) * sizeof(*key->values) );
     key->last_value--;
     touch_key( key, REG_NOTIFY_CHANGE_LAST_SET );
 
@@ -1450,6 +1581,80 @@ static int get_data_type( const char *buffer, int *type, int *parse_type )
     return 0;
 }
 
+/* create a key from its path, reusing the keys opened for the common part with the previous path */
+static struct key *create_loaded_key( struct key *base, const struct unicode_str *name,
+                                      struct file_load_info *info )
+{
+    struct key *key = base, *parent = base;
+    struct unicode_str tmp;
+    const WCHAR *str = name->str;
+    data_size_t pos = 0, len = name->len;
+    int depth = 0, same = 1;
+
+    while (len)
+    {
+        tmp.str = str;
+        tmp.len = get_path_element( str, len );
+
+        /* only reuse the element if the whole path up to it is unchanged */
+        same = same && depth < info->depth && pos + tmp.len <= info->pathlen &&
+               !memcmp( info->path + pos / sizeof(WCHAR), tmp.str, tmp.len ) &&
+               (pos + tmp.len == info->pathlen || info->path[(pos + tmp.len) / sizeof(WCHAR)] == '\\');
+        if (same) key = info->keys[depth];
+        else
+        {
+            if (depth == info->nb_keys)
+            {
+                int nb_keys = max( 16, info->nb_keys * 2 );
+                struct key **new_keys;
+
+                if (!(new_keys = realloc( info->keys, nb_keys * sizeof(*new_keys) )))
+                {
+                    set_error( STATUS_NO_MEMORY );
+                    key = NULL;
+                    break;
+                }
+                info->keys = new_keys;
+                info->nb_keys = nb_keys;
+            }
+            if (!(key = create_key_object( &parent->obj, &tmp, OBJ_OPENIF, 0, 0, NULL ))) break;
+            if (depth < info->depth) release_object( info->keys[depth] );
+            else info->depth++;
+            info->keys[depth] = key;
+        }
+        parent = key;
+        depth++;
+
+        /* skip trailing \\ and move to the next element */
+        if (tmp.len < len)
+        {
+            tmp.len += sizeof(WCHAR);
+            str += tmp.len / sizeof(WCHAR);
+            pos += tmp.len;
+            len -= tmp.len;
+        }
+        else break;
+    }
+
+    /* forget the elements that are no longer part of the path */
+    if (!key) depth = 0;
+    while (info->depth > depth) release_object( info->keys[--info->depth] );
+    info->pathlen = 0;
+    if (!key) return NULL;
+
+    if (name->len > info->pathsize)
+    {
+        WCHAR *new_path;
+
+        if (!(new_path = realloc( info->path, name->len ))) return (struct key *)grab_object( key );
+        info->path = new_path;
+        info->pathsize = name->len;
+    }
+    memcpy( info->path, name->str, name->len );
+    info->pathlen = name->len;
+    return (struct key *)grab_object( key );
+}
+
 /* load and create a key from the input file */
 static struct key *load_key( struct key *base, const char *buffer, int prefix_len,
                              struct file_load_info *info, timeout_t *modif )
@@ -1488,7 +1693,7 @@ static struct key *load_key( struct key *base, const char *buffer, int prefix_le
     }
     name.str = p;
     name.len = len - (p - info->tmp + 1) * sizeof(WCHAR);
-    return create_key_recursive( base, &name, 0 );
+    return create_loaded_key( base, &name, info );
 }
 
 /* update the modification time of a key (and its parents) after it has been loaded from a file */
@@ -1730,6 +1935,12 @@ static void load_keys( struct key *key, const char *filename, FILE *f, int prefi
     info.len    = 4;
     info.tmplen = 4;
     info.line   = 0;
+    info.path   = NULL;
+    info.pathlen  = 0;
+    info.pathsize = 0;
+    info.keys   = NULL;
+    info.depth  = 0;
+    info.nb_keys  = 0;
     if (!(info.buffer = mem_alloc( info.len ))) return;
     if (!(info.tmp = mem_alloc( info.tmplen )))
     {
@@ -1784,6 +1995,9 @@ static void load_keys( struct key *key, const char *filename, FILE *f, int prefi
         update_key_time( subkey, modif );
         release_object( subkey );
     }
+    while (info.depth) release_object( info.keys[--info.depth] );
+    free( info.keys );
+    free( info.path );
     free( info.buffer );
     free( info.tmp );
 }
@@ -2118,6 +2332,9 @@ static int save_branch( struct key *key, const char *filename )
         goto done;
     }
 
+    /* use a large buffer to limit the number of write calls */
+    setvbuf( f, NULL, _IOFBF, SAVE_BUFFER_SIZE );
+
     if (debug_level > 1)
     {
         fprintf( stderr, "%s: ", filename );
@@ -66,6 +66,9 @@
 #define SCM_RIGHTS 1
 #endif
 
+/* request data buffers up to this size are kept across requests */
+#define REQ_DATA_CACHE_SIZE 1024
+
 /* path names for server master Unix socket */
 static const char * const server_socket_name = "socket";   /* name of the socket file */
 static const char * const server_lock_name = "lock";       /* name of the server lock file */
@@ -292,6 +295,8 @@ static void call_req_handler( struct thread *thread )
 {
     union generic_reply reply;
     enum request req = thread->req.request_header.req;
+    struct process *process = thread->process;
+    timeout_t start, time;
 
     current = thread;
     current->reply_size = 0;
@@ -300,10 +305,17 @@ static void call_req_handler( struct thread *thread )
 
     if (debug_level) trace_request();
 
+    start = monotonic_counter();
     if (req < REQ_NB_REQUESTS)
         req_handlers[req]( &current->req, &reply );
     else
         set_error( STATUS_NOT_IMPLEMENTED );
+    time = monotonic_counter() - start;
+
+    /* the thread holds a reference to its process, so it's still valid here */
+    process->req_count++;
+    process->req_time += time;
+    record_request_stats( req, time );
 
     if (current)
     {
@@ -323,27 +335,63 @@ static void call_req_handler( struct thread *thread )
     current = NULL;
 }
 
+/* release the request data buffer once the request has been handled */
+static void free_request_data( struct thread *thread )
+{
+    /* keep small buffers around for the next request */
+    if (thread->req_data_size <= REQ_DATA_CACHE_SIZE) return;
+    free( thread->req_data );
+    thread->req_data = NULL;
+    thread->req_data_size = 0;
+}
+
 /* read a request from a thread */
 void read_request( struct thread *thread )
 {
+    data_size_t size;
     int ret;
 
     if (!thread->req_toread)  /* no pending request */
     {
-        if ((ret = read( get_unix_fd( thread->request_fd ), &thread->req,
-                         sizeof(thread->req) )) != sizeof(thread->req)) goto error;
-        if (!(thread->req_toread = thread->req.request_header.request_size))
+        struct iovec vec[2];
+
+        /* read the fixed part and as much of the variable part as fits in a single call */
+        vec[0].iov_base = &thread->req;
+        vec[0].iov_len  = sizeof(thread->req);
+        vec[1].iov_base = thread->req_data;
+        vec[1].iov_len  = thread->req_data_size;
+        if ((ret = readv( get_unix_fd( thread->request_fd ), vec, thread->req_data ? 2 : 1 )) <
+            (int)sizeof(thread->req)) goto error;
+
+        ret -= sizeof(thread->req);
+        size = thread->req.request_header.request_size;
+        if (ret > size)
         {
-            /* no data, handle request at once */
-            call_req_handler( thread );
+            fatal_protocol_error( thread, "extra data %d for request %d\n",
+                                  ret - size, thread->req.request_header.req );
             return;
         }
-        if (!(thread->req_data = malloc( thread->req_toread )))
+        if (!(thread->req_toread = size - ret))
         {
-            fatal_protocol_error( thread, "no memory for %u bytes request %d\n",
-                                  thread->req_toread, thread->req.request_header.req );
+            /* all data is available, handle request at once */
+            call_req_handler( thread );
+            free_request_data( thread );
             return;
         }
+        if (size > thread->req_data_size)
+        {
+            data_size_t new_size = max( size, REQ_DATA_CACHE_SIZE );
+            void *new_data;
+
+            if (!(new_data = realloc( thread->req_data, new_size )))
+            {
+                fatal_protocol_error( thread, "no memory for %u bytes request %d\n",
+                                      size, thread->req.request_header.req );
+                return;
+            }
+            thread->req_data = new_data;
+            thread->req_data_size = new_size;
+        }
     }
 
     /* read the variable sized data */
@@ -357,8 +405,7 @@ void read_request( struct thread *thread )
         if (!(thread->req_toread -= ret))
         {
             call_req_handler( thread );
-            free( thread->req_data );
-            thread->req_data = NULL;
+            free_request_data( thread );
             return;
         }
     }
@@ -65,6 +65,8 @@ extern int server_dir_fd, config_dir_fd;
 
 extern void trace_request(void);
 extern void trace_reply( enum request req, const union generic_reply *reply );
+extern void record_request_stats( enum request req, timeout_t time );
+extern void dump_request_stats(void);
 
 /* get current tick count to return to client */
 static inline unsigned int get_tick_count(void)
@@ -56,6 +56,7 @@
 #include "tcpmib.h"
 #include "file.h"
 #include "request.h"
+#include "process.h"
 #include "security.h"
 #include "unicode.h"
 #include "request_trace.h"
@@ -1704,3 +1705,80 @@ void trace_reply( enum request req, const union generic_reply *reply )
     else fprintf( stderr, "%04x: %d() = %s\n",
                   current->id, req, get_status_name(current->error) );
 }
+
+/* request statistics */
+
+#define REQ_HISTOGRAM_SIZE 16  /* buckets of log2 microseconds */
+
+struct request_stats
+{
+    unsigned int count;     /* number of requests of this type */
+    timeout_t    total;     /* total time spent in the handler */
+    timeout_t    max;       /* longest time spent in the handler */
+};
+
+static struct request_stats req_stats[REQ_NB_REQUESTS + 1];  /* last entry is for invalid requests */
+static unsigned int req_histogram[REQ_HISTOGRAM_SIZE];
+
+/* record the time spent handling a request */
+void record_request_stats( enum request req, timeout_t time )
+{
+    struct request_stats *stats = &req_stats[min( req, REQ_NB_REQUESTS )];
+    timeout_t usecs = time / 10;
+    unsigned int bucket = 0;
+
+    stats->count++;
+    stats->total += time;
+    if (time > stats->max) stats->max = time;
+
+    while (usecs && bucket < REQ_HISTOGRAM_SIZE - 1)
+    {
+        usecs >>= 1;
+        bucket++;
+    }
+    req_histogram[bucket]++;
+}
+
+static int dump_process_stats( struct process *process, void *user )
+{
+    if (process->req_count)
+        fprintf( stderr, "  %04x: %10u requests %12u us\n",
+                 process->id, process->req_count, (unsigned int)(process->req_time / 10) );
+    return 0;
+}
+
+/* dump the request statistics to stderr */
+void dump_request_stats(void)
+{
+    unsigned int i, count = 0;
+    timeout_t total = 0;
+
+    fprintf( stderr, "Request statistics:\n" );
+    fprintf( stderr, "  %-32s %10s %12s %10s %10s\n", "request", "count", "total us", "avg us", "max us" );
+    for (i = 0; i <= REQ_NB_REQUESTS; i++)
+    {
+        const struct request_stats *stats = &req_stats[i];
+
+        if (!stats->count) continue;
+        fprintf( stderr, "  %-32s %10u %12u %10u %10u\n",
+                 i < REQ_NB_REQUESTS ? req_names[i] : "(invalid)", stats->count,
+                 (unsigned int)(stats->total / 10), (unsigned int)(stats->total / 10 / stats->count),
+                 (unsigned int)(stats->max / 10) );
+        count += stats->count;
+        total += stats->total;
+    }
+    fprintf( stderr, "  %-32s %10u %12u\n", "total", count, (unsigned int)(total / 10) );
+
+    fprintf( stderr, "Latency histogram:\n" );
+    for (i = 0; i < REQ_HISTOGRAM_SIZE; i++)
+    {
+        if (!req_histogram[i]) continue;
+        if (i == REQ_HISTOGRAM_SIZE - 1)
+            fprintf( stderr, "  >= %8u us %10u\n", 1u << (i - 1), req_histogram[i] );
+        else
+            fprintf( stderr, "  <  %8u us %10u\n", 1u << i, req_histogram[i] );
+    }
+
+    fprintf( stderr, "Requests per process:\n" );
+    enum_processes( dump_process_stats, NULL );
+}
@@ -341,6 +341,19 @@ static unsigned int get_window_dpi( struct window *win )
     return NTUSER_DPI_CONTEXT_GET_DPI( win->shared->dpi_context );
 }
 
+/* publish the window styles in the session shared memory */
+static void update_shared_window_style( struct window *win )
+{
+    if (win->shared->style == win->style && win->shared->ex_style == win->ex_style) return;
+
+    SHARED_WRITE_BEGIN( win->shared, window_shm_t )
+    {
+        shared->style    = win->style;
+        shared->ex_style = win->ex_style;
+    }
+    SHARED_WRITE_END;
+}
+
 /* link a window at the right place in the siblings list */
 static int link_window( struct window *win, struct window *previous )
 {
@@ -397,6 +410,7 @@ static int link_window( struct window *win, struct window *previous )
     }
 
     win->is_linked = 1;
+    update_shared_window_style( win );
     return old_prev != win->entry.prev;
 }
 
@@ -691,6 +705,8 @@ static struct window *create_window( struct window *parent, struct window *owner
         shared->dpi_context     = NTUSER_DPI_PER_MONITOR_AWARE;
         shared->fnid            = 0;
         shared->private_size    = 0;
+        shared->style           = 0;
+        shared->ex_style        = 0;
     }
     SHARED_WRITE_END;
 
@@ -1960,6 +1976,7 @@ static void set_window_pos( struct window *win, struct window *previous,
     if (!(swp_flags & SWP_NOZORDER) && win->parent) zorder_changed |= link_window( win, previous );
     if (swp_flags & SWP_SHOWWINDOW) win->style |= WS_VISIBLE;
     else if (swp_flags & SWP_HIDEWINDOW) win->style &= ~WS_VISIBLE;
+    update_shared_window_style( win );
 
     /* keep children at the same position relative to top right corner when the parent is mirrored */
     if (win->ex_style & WS_EX_LAYOUTRTL)
@@ -2140,6 +2157,7 @@ void free_window_handle( struct window *win )
     {
         struct region *vis_rgn = get_visible_region( win, DCX_WINDOW );
         win->style &= ~WS_VISIBLE;
+        update_shared_window_style( win );
         if (vis_rgn)
         {
             struct region *exposed_rgn = expose_window( win, &win->window_rect, vis_rgn, 0 );
@@ -2267,6 +2285,7 @@ DECL_HANDLER(create_window)
 
     win->style = req->style;
     win->ex_style = req->ex_style;
+    update_shared_window_style( win );
 
     reply->handle      = win->handle;
     reply->parent      = win->parent ? win->parent->handle : 0;
@@ -2349,6 +2368,7 @@ DECL_HANDLER(get_desktop_window)
         {
             detach_window_thread( desktop->top_window );
             desktop->top_window->style  = WS_POPUP | WS_VISIBLE | WS_CLIPSIBLINGS | WS_CLIPCHILDREN;
+            update_shared_window_style( desktop->top_window );
         }
     }
 
@@ -2362,6 +2382,7 @@ DECL_HANDLER(get_desktop_window)
         {
             detach_window_thread( desktop->msg_window );
             desktop->msg_window->style = WS_POPUP | WS_CLIPSIBLINGS | WS_CLIPCHILDREN;
+            update_shared_window_style( desktop->msg_window );
         }
     }
 
@@ -2442,6 +2463,7 @@ DECL_HANDLER(init_window_info)
     win->style = req->style;
     win->ex_style = req->ex_style;
     win->is_unicode = req->is_unicode;
+    update_shared_window_style( win );
 
     /* changing window style triggers a non-client paint */
     win->paint_flags |= PAINT_NONCLIENT;
@@ -2466,12 +2488,14 @@ DECL_HANDLER(set_window_info)
         reply->old_info = win->style;
         win->style = req->new_info;
         fix_window_ex_style( win );
+        update_shared_window_style( win );
         /* changing window style triggers a non-client paint */
         win->paint_flags |= PAINT_NONCLIENT;
         break;
     case GWL_EXSTYLE:
         reply->old_info = win->ex_style;
         set_window_ex_style( win, req->new_info );
+        update_shared_window_style( win );
         break;
     case GWLP_ID:
         reply->old_info = win->id;